@@ -3,3 +3,7 @@ DEBOUNCE_TYPE = sym_eager_pk
 
 # gcc optimization
 OPT = 2
+
+# read each column port once per row
+CUSTOM_MATRIX = lite
+SRC += lib/port_matrix.c
@@ -8,3 +8,7 @@ RGB_MATRIX_ENABLE = yes        # Use RGB matrix
 
 # gcc optimization
 OPT = s  # optimize for size
+
+# read each column port once per row
+CUSTOM_MATRIX = lite
+SRC += lib/port_matrix.c
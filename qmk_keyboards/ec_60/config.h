@@ -151,3 +151,6 @@ typedef struct {
 #  define EC_TEST_BOTTOM_ROW 2
 #  define EC_TEST_BOTTOM_COL 7
 #endif
+
+// whole calibration dump fits in the send buffer
+#define SEND_BUFFER_SIZE 4096
@@ -228,17 +228,18 @@ void ec_config_save_calibration_key(uint8_t row, uint8_t col) {
 }
 
 void ec_config_send_calibration_data(void) {
-  send_string("// clang-format off\n");
-  send_string("const uint16_t PROGMEM ec_bottoming_reading_default[MATRIX_ROWS][MATRIX_COLS] = ");
+  send_buffer_string("// clang-format off\n");
+  send_buffer_string(
+    "const uint16_t PROGMEM ec_bottoming_reading_default[MATRIX_ROWS][MATRIX_COLS] = ");
   SEND_C_2D_ARRAY(ec_eeprom_config.bottoming_reading, MATRIX_ROWS, MATRIX_COLS, WORD, ";\n");
-  send_string("const uint16_t PROGMEM ec_noise_floor_default[MATRIX_ROWS][MATRIX_COLS] = ");
+  send_buffer_string("const uint16_t PROGMEM ec_noise_floor_default[MATRIX_ROWS][MATRIX_COLS] = ");
   SEND_C_2D_ARRAY(ec_eeprom_config.noise_floor, MATRIX_ROWS, MATRIX_COLS, WORD, ";\n");
-  send_string("// clang-format on\n");
+  send_buffer_string("// clang-format on\n");
 }
 
 void ec_config_send_presets(void) {
-  send_string("// clang-format off\n");
-  send_string("const ec_preset_t PROGMEM ec_presets_default[EC_NUM_PRESETS] = ");
+  send_buffer_string("// clang-format off\n");
+  send_buffer_string("const ec_preset_t PROGMEM ec_presets_default[EC_NUM_PRESETS] = ");
   SEND_C_INDEXED_ARRAY_CODE(
     EC_NUM_PRESETS, ";\n",
     (
@@ -275,7 +276,7 @@ void ec_config_send_presets(void) {
       SEND_C_PROP_ARROW_VALUE(preset, sub_action_release_threshold, WORD, "\n");
       //
       ));
-  send_string("// clang-format on\n");
+  send_buffer_string("// clang-format on\n");
 }
 
 #ifdef EC_DEBUG_ENABLE
@@ -291,7 +292,7 @@ void ec_config_send_presets(void) {
                                     (SEND_##type(ec_test_result[i][j].prop);));
 
 void ec_config_debug_send_debug_values(void) {
-  send_string("const misc_state = {\n");
+  send_buffer_string("const misc_state = {\n");
 #  ifdef DEBUG_MATRIX_SCAN_RATE
   uint32_t matrix_scan_rate = get_matrix_scan_rate();
   SEND_JS_PROP_VALUE(matrix_scan_rate, WORD, ",\n");
@@ -299,19 +300,19 @@ void ec_config_debug_send_debug_values(void) {
   SEND_JS_PROP_VALUE(ec_eeprom_config_reseted, BOOL, ",\n");
   SEND_JS_PROP_VALUE(ec_eeprom_config_error, WORD, ",\n");
   SEND_EC_CONFIG_KEY_MATRIX(extremum, WORD, ",\n");
-  send_string("scan_test_result: {\n");
+  send_buffer_string("scan_test_result: {\n");
   SEND_JS_TEST_RESULT(floor_min, WORD, ",\n");
   SEND_JS_TEST_RESULT(floor_max, WORD, ",\n");
   SEND_JS_NAME_PROP_2D_ARRAY_CODE(
     "floor_noise", EC_TEST_CHARGE_PLOT_COUNT, EC_TEST_DISCHARGE_PLOT_COUNT, ",\n",
     (SEND_WORD(ec_test_result[i][j].floor_max - ec_test_result[i][j].floor_min)))
   SEND_JS_TEST_RESULT(bottom_max, WORD, "\n");
-  send_string("}\n");
-  send_string("}\n");
+  send_buffer_string("}\n");
+  send_buffer_string("}\n");
 }
 
 void ec_config_debug_send_calibration(void) {
-  send_string("const calibrtion = {\n");
+  send_buffer_string("const calibrtion = {\n");
   SEND_JS_PROP_VALUE(bottoming_update_count, WORD, ",\n");
   SEND_EC_CONFIG_KEY_MATRIX(noise, BYTE, ",\n");
   SEND_EC_CONFIG_KEY_MATRIX(actuation_count, WORD, ",\n");
@@ -327,11 +328,11 @@ void ec_config_debug_send_calibration(void) {
     "SNR_percentage", MATRIX_ROWS, MATRIX_COLS, "\n",
     (SEND_WORD(ec_config_keys[i][j].noise * 100 /
                (ec_eeprom_config.bottoming_reading[i][j] - ec_eeprom_config.noise_floor[i][j]));));
-  send_string("}\n");
+  send_buffer_string("}\n");
 }
 
 void ec_config_debug_send_config_keys(void) {
-  send_string("const key_config = {\n");
+  send_buffer_string("const key_config = {\n");
   SEND_EC_CONFIG_KEY_MATRIX_MODE(actuation_mode, ",\n");
   SEND_EC_CONFIG_KEY_MATRIX(actuation_reference, WORD, ",\n");
   SEND_EC_CONFIG_KEY_MATRIX_MODE(release_mode, ",\n");
@@ -341,7 +342,7 @@ void ec_config_debug_send_config_keys(void) {
   SEND_EC_CONFIG_KEY_MATRIX(sub_action_actuation_threshold, WORD, ",\n");
   SEND_EC_CONFIG_KEY_MATRIX_MODE(sub_action_release_mode, ",\n");
   SEND_EC_CONFIG_KEY_MATRIX(sub_action_release_threshold, WORD, "\n");
-  send_string("}\n");
+  send_buffer_string("}\n");
 }
 
 void ec_config_debug_send_all(void) {
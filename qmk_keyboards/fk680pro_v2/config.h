@@ -22,6 +22,16 @@
 #define WS2812_DMA_STREAM STM32_DMA1_STREAM2
 #define WS2812_DMA_CHANNEL 2
 
+/* rgb_matrix_budget.c */
+#define RGB_MATRIX_RENDER_BUDGET_US 200
+// adjusted at runtime, evaluates to 1 in #if
+#define RGB_MATRIX_LED_PROCESS_LIMIT \
+  (rgb_matrix_led_process_limit ? rgb_matrix_led_process_limit : 1)
+#ifndef __ASSEMBLER__
+#  include <stdint.h>
+extern uint8_t rgb_matrix_led_process_limit;
+#endif
+
 /* definitions for my_keyboard_commoon lib */
 #define RGB_MATRIX_CAPS_LOCK_LED 3  // left side of spacebar
 #define RADIAL_CONTROLLER_DIAL_MODE_DEFAULT KEYSWITCH
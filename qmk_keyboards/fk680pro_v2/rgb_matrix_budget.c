@@ -0,0 +1,95 @@
+/* Copyright 2024 jhorology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// RGB matrix driver (RGB_MATRIX_DRIVER = custom) on top of ws2812.
+//  - colors are staged and compared with the last flushed frame in flush(), a frame whose
+//    LEDs end up the same (static effects, indicators painted over the effect) is not sent.
+//  - number of LEDs rendered per main loop iteration (RGB_MATRIX_LED_PROCESS_LIMIT) is
+//    adjusted every frame from the measured render time to stay within
+//    RGB_MATRIX_RENDER_BUDGET_US.
+
+#include QMK_KEYBOARD_H
+
+#include <ws2812.h>
+
+// 1/16 us
+#define US_PER_LED_SCALE 16
+
+uint8_t rgb_matrix_led_process_limit = RGB_MATRIX_LED_COUNT;
+
+static rgb_t pending[RGB_MATRIX_LED_COUNT];
+static rgb_t flushed[RGB_MATRIX_LED_COUNT];
+static bool flushed_valid;
+static bool slice_started;
+static rtcnt_t slice_start;
+static uint32_t us_per_led;
+
+static void init(void) { ws2812_init(); }
+
+static void set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+  if (!slice_started) {
+    slice_start = chSysGetRealtimeCounterX();
+    slice_started = true;
+  }
+  pending[index] = (rgb_t){.r = red, .g = green, .b = blue};
+}
+
+static void set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
+  for (int i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+    set_color(i, red, green, blue);
+  }
+}
+
+// between frames, the limit must not change while a frame is being rendered.
+static void flush(void) {
+  if (us_per_led) {
+    uint32_t limit = RGB_MATRIX_RENDER_BUDGET_US * US_PER_LED_SCALE / us_per_led;
+    rgb_matrix_led_process_limit = MAX(MIN(limit, RGB_MATRIX_LED_COUNT), 1);
+  }
+  bool dirty = false;
+  for (int i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+    rgb_t *led = &pending[i];
+    if (!flushed_valid || led->r != flushed[i].r || led->g != flushed[i].g ||
+        led->b != flushed[i].b) {
+      ws2812_set_color(i, led->r, led->g, led->b);
+      flushed[i] = *led;
+      dirty = true;
+    }
+  }
+  if (dirty) {
+    ws2812_flush();
+    flushed_valid = true;
+  }
+}
+
+const rgb_matrix_driver_t rgb_matrix_driver = {
+  .init = init,
+  .flush = flush,
+  .set_color = set_color,
+  .set_color_all = set_color_all,
+};
+
+// called at the end of every render step with its LED range
+bool rgb_matrix_indicators_advanced_kb(uint8_t led_min, uint8_t led_max) {
+  uint32_t us = RTC2US(REALTIME_COUNTER_CLOCK, chSysGetRealtimeCounterX() - slice_start);
+  // a slice that started with set_color() from outside of the effect is not a sample
+  if (slice_started && led_max > led_min && us < RGB_MATRIX_RENDER_BUDGET_US * 16) {
+    uint32_t sample = us * US_PER_LED_SCALE / (led_max - led_min);
+    us_per_led = us_per_led ? (us_per_led * 7 + sample) / 8 : sample;
+  }
+  slice_started = false;
+  return rgb_matrix_indicators_advanced_user(led_min, led_max);
+}
@@ -2,6 +2,10 @@
 MCU_LDSCRIPT = STM32F103xB
 
 RGB_MATRIX_ENABLE = yes
+# ws2812 through rgb_matrix_budget.c
+RGB_MATRIX_DRIVER = custom
+WS2812_DRIVER_REQUIRED = yes
+SRC += rgb_matrix_budget.c
 
 # debounce
 DEBOUNCE_TYPE = sym_eager_pk
@@ -11,6 +15,11 @@ OS_FINGERPRINT_DEBUG_ENABLE = yes
 OPT_DEFS += -DOS_FINGERPRINT_DEBUG_ENABLE
 SEND_STRING_ENABLE = yes
 
+# key to report latency
+LATENCY_TRACER_ENABLE = yes
+OPT_DEFS += -DLATENCY_TRACER_ENABLE
+SRC += lib/latency_tracer.c
+
 # radial controller
 RADIAL_CONTROLLER_ENABLE = yes
 SRC += lib/radial_controller.c
@@ -5,3 +5,7 @@ DEBOUNCE_TYPE = sym_eager_pk
 
 # gcc optimization
 OPT = s  # optimize for size
+
+# read each column port once per row
+CUSTOM_MATRIX = lite
+SRC += lib/port_matrix.c
@@ -15,7 +15,13 @@
  */
 #include "custom_config.h"
 
+#include <deferred_exec.h>
 #include <eeprom.h>
+#if defined(PROTOCOL_CHIBIOS)
+#  include <usb_main.h>
+#elif defined(PROTOCOL_LUFA)
+#  include <LUFA/Drivers/USB/USB.h>
+#endif
 
 #include "custom_keycodes.h"
 #include "tap_dance.h"
@@ -42,6 +48,11 @@
 #  define CUSTOM_CONFIG_NON_MAC_FN_CURSOR_DEFAULT true
 #endif
 
+// bus detached time for re-enumeration
+#ifndef CUSTOM_CONFIG_USB_DETACH_MILLIS
+#  define CUSTOM_CONFIG_USB_DETACH_MILLIS 50
+#endif
+
 #ifdef RADIAL_CONTROLLER_ENABLE
 #  ifndef RADIAL_CONTROLLER_ENCODER_CLICKS_DEFAULT
 #    define RADIAL_CONTROLLER_ENCODER_CLICKS_DEFAULT 36
@@ -57,6 +68,10 @@
 #  ifndef RADIAL_CONTROLLER_FINE_TUNE_MODS_DEFAULT
 #    define RADIAL_CONTROLLER_FINE_TUNE_MODS_DEFAULT 0x10
 #  endif
+// velocity acceleration gain 0: none, 1-7
+#  ifndef RADIAL_CONTROLLER_ACCELERATION_DEFAULT
+#    define RADIAL_CONTROLLER_ACCELERATION_DEFAULT 0
+#  endif
 #  define RADIAL_CONTROLLER_KEY_ANGULAR_SPEED_OFFSET 15
 #endif
 
@@ -70,6 +85,10 @@ rc_config_t rc_config;
 static void _custom_config_raw_hid_set_enable(bool enable);
 static void _custom_config_mac_set_enable(bool enable);
 static void _custom_config_usj_set_enable(bool enable);
+static void usb_reconnect(void);
+#ifdef PROTOCOL_LUFA
+static uint32_t usb_attach_callback(uint32_t trigger_time, void *cb_arg);
+#endif
 
 void custom_config_reset() {
   kb_config.raw = 0;
@@ -89,6 +108,7 @@ void custom_config_reset() {
     RADIAL_CONTROLLER_KEY_ANGULAR_SPEED_DEFAULT - RADIAL_CONTROLLER_KEY_ANGULAR_SPEED_OFFSET;
   rc_config.fine_tune_ratio = RADIAL_CONTROLLER_FINE_TUNE_RATIO_DEFAULT;
   rc_config.fine_tune_mods = RADIAL_CONTROLLER_FINE_TUNE_MODS_DEFAULT;
+  rc_config.acceleration = RADIAL_CONTROLLER_ACCELERATION_DEFAULT;
   eeprom_update_dword((uint32_t *)RADIAL_CONTROLLER_EEPROM_ADDR, rc_config.raw);
 #endif
 }
@@ -102,7 +122,6 @@ void custom_config_init() {
   setPinOutput(CUSTOM_CONFIG_RHID_MODE_PIN);
 #endif
 #ifdef CUSTOM_CONFIG_MAC_MODE_PIN
-  // write pin at initialize time only. mac mode is never changed without restart.
   setPinOutput(CUSTOM_CONFIG_MAC_MODE_PIN);
   writePin(CUSTOM_CONFIG_MAC_MODE_PIN, kb_config.mac);
 #endif
@@ -130,16 +149,16 @@ bool process_record_custom_config(uint16_t keycode, keyrecord_t *record) {
         return false;
 #ifndef DIP_SWITCH_ENABLE
       case MAC_ON:
-        // *keyboard may restart
+        // *USB may reconnect
         custom_config_mac_set_enable(normal_true);
         return false;
       case MAC_OFF:
-        // *keyboard may restart
+        // *USB may reconnect
         custom_config_mac_set_enable(normal_false);
         return false;
 #endif
       case AUT_ON:
-        // *keyboard may restart
+        // *USB may reconnect
         custom_config_auto_detect_set_enable(normal_true);
         return false;
       case AUT_OFF:
@@ -200,23 +219,38 @@ bool custom_config_mac_is_enable() { return kb_config.mac; }
 
 void custom_config_mac_toggle_enable() { custom_config_mac_set_enable(!kb_config.mac); }
 
-static void _custom_config_mac_set_enable(bool enable) { kb_config.mac = enable; }
+static void _custom_config_mac_set_enable(bool enable) {
+  kb_config.mac = enable;
+#ifdef CUSTOM_CONFIG_MAC_MODE_PIN
+  writePin(CUSTOM_CONFIG_MAC_MODE_PIN, enable);
+#endif
+}
 
 void custom_config_mac_set_enable(bool enable) {
   if (enable != kb_config.mac) {
     _custom_config_mac_set_enable(enable);
     eeconfig_update_kb(kb_config.raw);
-    // reboot for changing USB device descriptor
-    soft_reset_keyboard();
+    custom_config_mac_update_default_layer();
+#ifdef ALTERNATE_PRODUCT_ID
+    // re-enumerate for changing USB device descriptor
+    usb_reconnect();
+#endif
   }
 }
 void custom_config_mac_set_enable_without_reset(bool enable) {
   if (enable != kb_config.mac) {
     _custom_config_mac_set_enable(enable);
     eeconfig_update_kb(kb_config.raw);
+    custom_config_mac_update_default_layer();
   }
 }
 
+void custom_config_mac_update_default_layer() {
+#if defined(MAC_BASE_LAYER) && defined(NON_MAC_BASE_LAYER)
+  default_layer_set(kb_config.mac ? (1 << MAC_BASE_LAYER) : (1 << NON_MAC_BASE_LAYER));
+#endif
+}
+
 bool custom_config_auto_detect_is_enable() { return kb_config.auto_detect; }
 
 void custom_config_auto_detect_toggle_enable() {
@@ -228,7 +262,8 @@ void custom_config_auto_detect_set_enable(bool enable) {
     kb_config.auto_detect = enable;
     eeconfig_update_kb(kb_config.raw);
     if (enable) {
-      soft_reset_keyboard();
+      // re-enumerate for detecting OS
+      usb_reconnect();
     }
   }
 }
@@ -259,6 +294,27 @@ void custom_config_non_mac_fn_set_cursor(bool enable) {
   }
 }
 
+// re-enumerate USB keeping firmware state, instead of rebooting.
+static void usb_reconnect() {
+  clear_keyboard();
+#if defined(PROTOCOL_CHIBIOS)
+  restart_usb_driver(&USB_DRIVER);
+#elif defined(PROTOCOL_LUFA)
+  USB_Detach();
+  USB_DeviceState = DEVICE_STATE_Unattached;
+  defer_exec(CUSTOM_CONFIG_USB_DETACH_MILLIS, usb_attach_callback, NULL);
+#else
+  soft_reset_keyboard();
+#endif
+}
+
+#ifdef PROTOCOL_LUFA
+static uint32_t usb_attach_callback(uint32_t trigger_time, void *cb_arg) {
+  USB_Attach();
+  return 0;
+}
+#endif
+
 // radial controller
 
 #ifdef RADIAL_CONTROLLER_ENABLE
@@ -283,6 +339,8 @@ bool custom_config_rc_is_fine_tune_mods_now() {
   }
   return false;
 }
+
+uint8_t custom_config_rc_get_acceleration() { return rc_config.acceleration; }
 #endif  // RADIAL_CONTROLLER_ENABLE
 
 // dynamic tap dance
@@ -300,6 +358,7 @@ void dynamic_tap_dance_reset() {
     eeprom_update_block((uint8_t *)&data,
                         (uint8_t *)(DYNAMIC_TAP_DANCE_EEPROM_ADDR + sizeof(tap_dance_entry_t) * i),
                         sizeof(tap_dance_entry_t));
+    tap_dance_update_outcomes(i);
   }
 }
 
@@ -45,6 +45,7 @@ typedef union {
     uint8_t key_angular_speed;    // degree per second, 15 - 270 (offset 15)
     uint8_t fine_tune_ratio : 2;  // power-of-2 divider 0: none, 1: 1/2, 2:1/4, 3:1/8
     uint8_t fine_tune_mods : 5;   // bit0: ctrl, bit1: shift, bit2: alt, bit3: gui, bit4: fn🌐
+    uint8_t acceleration : 3;     // velocity gain 0: none, 1-7: up to (1 + n) times
   };
 } rc_config_t;
 extern rc_config_t rc_config;
@@ -75,6 +76,7 @@ void custom_config_auto_detect_toggle_enable(void);
 void custom_config_auto_detect_set_enable(bool);
 
 void custom_config_mac_set_enable_without_reset(bool);
+void custom_config_mac_update_default_layer(void);
 
 uint8_t custom_config_non_mac_fn_fkey_is_enable(void);
 void custom_config_non_mac_fn_set_fkey(bool);
@@ -89,6 +91,7 @@ uint16_t custom_config_rc_get_key_angular_speed(void);
 uint8_t custom_config_rc_get_fine_tune_ratio(void);
 uint8_t custom_config_rc_is_fine_tune_mods(void);
 bool custom_config_rc_is_fine_tune_mods_now(void);
+uint8_t custom_config_rc_get_acceleration(void);
 #endif
 
 void dynamic_tap_dance_reset(void);
@@ -134,6 +134,21 @@ const RADIAL_CONTROLLER_MENU = {
           label: 'Fine-tune Modifier: fn🌐',
           type: 'toggle',
           content: ['id_custom_rc_fine_tune_mod_apple_fn', ID_CUSTOM_RC_CHANNEL, 8]
+        },
+        {
+          label: 'Acceleration: (max speed at fast rotation)',
+          type: 'dropdown',
+          options: [
+            ['None', 0],
+            ['x2', 1],
+            ['x3', 2],
+            ['x4', 3],
+            ['x5', 4],
+            ['x6', 5],
+            ['x7', 6],
+            ['x8', 7]
+          ],
+          content: ['id_custom_rc_acceleration', ID_CUSTOM_RC_CHANNEL, 9]
         }
       ]
     }
@@ -120,10 +120,10 @@ static bool process_layout_conversion(layout_conversion_item_t *table, uint16_t
       if (clear_shift) del_mods(cur_shift);
       register_code16(kc);
       if (kc & QK_LSFT) {
-        del_weak_mods(KC_LSFT);
+        del_weak_mods(MOD_BIT(KC_LSFT));
       }
       if (kc & QK_LALT) {
-        del_weak_mods(KC_LALT);
+        del_weak_mods(MOD_BIT(KC_LALT));
       }
       if (clear_shift) add_mods(cur_shift);
       override_key_flags |= flag;
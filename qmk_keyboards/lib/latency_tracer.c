@@ -0,0 +1,282 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "latency_tracer.h"
+
+#ifdef LATENCY_TRACER_ENABLE
+
+#  include <host.h>
+#  include <raw_hid.h>
+#  include <string.h>
+
+#  define VERSION 1
+
+// key events waiting for their report. tap dance and tap-hold keys wait for the tapping term.
+#  ifndef LATENCY_TRACER_MAX_PENDING
+#    define LATENCY_TRACER_MAX_PENDING 8
+#  endif
+
+// events without a report by then are counted as "no report"
+#  ifndef LATENCY_TRACER_TIMEOUT_MILLIS
+#    define LATENCY_TRACER_TIMEOUT_MILLIS 2000
+#  endif
+
+#  if defined(PROTOCOL_CHIBIOS) && defined(MCU_RP)
+#    define TIMESTAMP() (TIMER->TIMERAWL)
+#    define TICKS_TO_US(ticks) (ticks)
+#    define RESOLUTION_US 1
+#  elif defined(PROTOCOL_CHIBIOS) && (PORT_SUPPORTS_RT == TRUE)
+#    define TIMESTAMP() chSysGetRealtimeCounterX()
+#    define TICKS_TO_US(ticks) ((ticks) / (REALTIME_COUNTER_CLOCK / 1000000))
+#    define RESOLUTION_US 1
+#  else
+#    define TIMESTAMP() timer_read32()
+#    define TICKS_TO_US(ticks) ((ticks)*1000)
+#    define RESOLUTION_US 1000
+#  endif
+
+#  define BUCKETS_PER_PACKET 13
+
+typedef struct {
+  uint32_t start;
+  keypos_t key;
+  bool pressed;
+  bool used;
+  uint8_t path;
+} trace_t;
+
+typedef struct {
+  uint32_t count;
+  uint32_t no_report;
+  uint32_t min_us;
+  uint32_t max_us;
+  uint32_t total_us;
+  uint16_t buckets[LATENCY_TRACER_BUCKETS];
+} latency_stats_t;
+
+static trace_t traces[LATENCY_TRACER_MAX_PENDING];
+// event being processed, the first report sent while it's set is its report
+static trace_t *active;
+static bool active_reported;
+static uint32_t active_latency_us;
+static latency_stats_t stats[LATENCY_PATH_COUNT];
+
+static host_driver_t *host_driver;
+static host_driver_t tracer_driver;
+
+// index = (msb - 1) * 4 + the 2 bits below msb, e.g. 13us (0b1101): msb 3 -> 8 + 2 = 10
+static uint8_t latency_bucket(uint32_t us) {
+  if (us < LATENCY_TRACER_SUB_BUCKETS) {
+    return us;
+  }
+  uint8_t msb = 31 - __builtin_clzl(us);
+  uint32_t index = (msb - 1) * LATENCY_TRACER_SUB_BUCKETS + ((us >> (msb - 2)) & 3);
+  return MIN(index, LATENCY_TRACER_BUCKETS - 1);
+}
+
+static void add_sample(uint8_t path, uint32_t us) {
+  latency_stats_t *s = &stats[path];
+  if (s->count == 0 || us < s->min_us) {
+    s->min_us = us;
+  }
+  if (us > s->max_us) {
+    s->max_us = us;
+  }
+  s->count++;
+  s->total_us += us;
+  uint16_t *bucket = &s->buckets[latency_bucket(us)];
+  if (*bucket != UINT16_MAX) {
+    (*bucket)++;
+  }
+}
+
+static void drop(trace_t *trace) {
+  stats[trace->path].no_report++;
+  trace->used = false;
+}
+
+static void on_report(void) {
+  uint32_t now = TIMESTAMP();
+  if (active && !active_reported) {
+    active_latency_us = TICKS_TO_US(now - active->start);
+    active_reported = true;
+  }
+}
+
+static void send_keyboard(report_keyboard_t *report) {
+  on_report();
+  host_driver->send_keyboard(report);
+}
+
+static void send_nkro(report_nkro_t *report) {
+  on_report();
+  host_driver->send_nkro(report);
+}
+
+// protocol sets the driver after keyboard_post_init, and may set it again later
+static void wrap_host_driver(void) {
+  host_driver_t *driver = host_get_driver();
+  if (driver == NULL || driver == &tracer_driver) {
+    return;
+  }
+  host_driver = driver;
+  tracer_driver = *driver;
+  tracer_driver.send_keyboard = send_keyboard;
+  tracer_driver.send_nkro = send_nkro;
+  host_set_driver(&tracer_driver);
+}
+
+static void put_u16(uint8_t *p, uint16_t value) {
+  p[0] = value;
+  p[1] = value >> 8;
+}
+
+static void put_u32(uint8_t *p, uint32_t value) {
+  put_u16(p, value);
+  put_u16(p + 2, value >> 16);
+}
+
+void latency_tracer_key_event(uint16_t keycode, keyrecord_t *record) {
+  uint32_t now = TIMESTAMP();
+  trace_t *trace = NULL;
+  for (uint8_t i = 0; i < LATENCY_TRACER_MAX_PENDING; i++) {
+    trace_t *t = &traces[i];
+    if (!t->used) {
+      trace = t;
+      break;
+    }
+    if (t != active && (trace == NULL || now - t->start > now - trace->start)) {
+      trace = t;
+    }
+  }
+  if (trace == NULL) {
+    return;
+  }
+  if (trace->used) {
+    drop(trace);
+  }
+  trace->start = now;
+  trace->key = record->event.key;
+  trace->pressed = record->event.pressed;
+  trace->path = IS_QK_TAP_DANCE(keycode) ? LATENCY_PATH_TAP_DANCE : LATENCY_PATH_PLAIN;
+  trace->used = true;
+}
+
+void latency_tracer_process_record(uint16_t keycode, keyrecord_t *record) {
+  latency_tracer_finish();
+  // tap dance key itself, traced when tap_dance.c processes the resolved keycode
+  if (IS_QK_TAP_DANCE(keycode)) {
+    return;
+  }
+  uint32_t now = TIMESTAMP();
+  for (uint8_t i = 0; i < LATENCY_TRACER_MAX_PENDING; i++) {
+    trace_t *t = &traces[i];
+    if (t->used && KEYEQ(t->key, record->event.key) && t->pressed == record->event.pressed &&
+        (active == NULL || now - t->start > now - active->start)) {
+      active = t;
+    }
+  }
+  active_reported = false;
+}
+
+void latency_tracer_tap_dance_resolved(keyrecord_t *record) {
+  uint32_t now = TIMESTAMP();
+  for (uint8_t i = 0; i < LATENCY_TRACER_MAX_PENDING; i++) {
+    trace_t *t = &traces[i];
+    if (t->used && KEYEQ(t->key, record->event.key) && t->pressed == record->event.pressed) {
+      t->start = now;
+    }
+  }
+}
+
+void latency_tracer_set_path(latency_path_t path) {
+  if (active && active->path == LATENCY_PATH_PLAIN) {
+    active->path = path;
+  }
+}
+
+void latency_tracer_finish(void) {
+  if (active == NULL) {
+    return;
+  }
+  if (active_reported) {
+    add_sample(active->path, active_latency_us);
+    active->used = false;
+  } else {
+    drop(active);
+  }
+  active = NULL;
+}
+
+void latency_tracer_task(void) {
+  wrap_host_driver();
+  latency_tracer_finish();
+  uint32_t now = TIMESTAMP();
+  for (uint8_t i = 0; i < LATENCY_TRACER_MAX_PENDING; i++) {
+    trace_t *t = &traces[i];
+    if (t->used && TICKS_TO_US(now - t->start) > LATENCY_TRACER_TIMEOUT_MILLIS * 1000UL) {
+      drop(t);
+    }
+  }
+}
+
+bool latency_tracer_raw_hid_receive(uint8_t *data, uint8_t length) {
+  if (data[0] != LATENCY_TRACER_RAW_HID_ID) {
+    return false;
+  }
+  uint8_t command = data[1];
+  uint8_t path = data[2];
+  if ((command == LATENCY_TRACER_STATS || command == LATENCY_TRACER_BUCKETS_READ) &&
+      path >= LATENCY_PATH_COUNT) {
+    command = 0;
+  }
+  switch (command) {
+    case LATENCY_TRACER_INFO:
+      data[2] = VERSION;
+      data[3] = LATENCY_PATH_COUNT;
+      data[4] = LATENCY_TRACER_BUCKETS;
+      data[5] = LATENCY_TRACER_SUB_BUCKETS;
+      put_u16(&data[6], RESOLUTION_US);
+      break;
+    case LATENCY_TRACER_STATS:
+      put_u32(&data[3], stats[path].count);
+      put_u32(&data[7], stats[path].no_report);
+      put_u32(&data[11], stats[path].min_us);
+      put_u32(&data[15], stats[path].max_us);
+      put_u32(&data[19], stats[path].total_us);
+      break;
+    case LATENCY_TRACER_BUCKETS_READ: {
+      uint8_t first = data[3];
+      uint8_t n = first < LATENCY_TRACER_BUCKETS
+                    ? MIN(LATENCY_TRACER_BUCKETS - first, BUCKETS_PER_PACKET)
+                    : 0;
+      data[4] = n;
+      for (uint8_t i = 0; i < n; i++) {
+        put_u16(&data[5 + i * 2], stats[path].buckets[first + i]);
+      }
+      break;
+    }
+    case LATENCY_TRACER_RESET:
+      memset(stats, 0, sizeof(stats));
+      break;
+    default:
+      data[0] = id_unhandled;
+      break;
+  }
+  raw_hid_send(data, length);
+  return true;
+}
+
+#endif
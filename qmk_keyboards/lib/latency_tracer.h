@@ -0,0 +1,92 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <quantum.h>
+
+/*
+ * key to report latency tracer.
+ *
+ * a key event is stamped when the debounced matrix change is handed to the action layer, and
+ * again when the first keyboard/NKRO report that results from it is passed to the host driver.
+ * a tap dance is stamped again when it resolves, its latency doesn't include the hold or the
+ * wait for the tapping term.
+ * latencies go into per path histograms that can be read over raw HID.
+ *
+ * buckets are log-linear in us: 0-3us have a bucket each, then every power of 2 is split
+ * into 4 equal buckets ([4,5)..[7,8), [8,10)..[14,16), ...), up to 2^22us. the last bucket
+ * also counts everything above.
+ *
+ * timer: RP2040 1MHz timer, ChibiOS realtime counter, or timer_read32() (1ms) on others.
+ *
+ * rules.mk:
+ *   LATENCY_TRACER_ENABLE = yes
+ *   OPT_DEFS += -DLATENCY_TRACER_ENABLE
+ *   SRC += lib/latency_tracer.c
+ *
+ * raw HID (request -> response, 32 bytes):
+ *   [id, INFO]                 -> [id, INFO, version, paths, buckets, sub buckets, res us(u16)]
+ *   [id, STATS, path]          -> [id, STATS, path, count, no report, min, max, total us(u32)]
+ *   [id, BUCKETS, path, first] -> [id, BUCKETS, path, first, n, count(u16) * n]
+ *   [id, RESET]                -> [id, RESET]
+ *   multi-byte values are little endian.
+ */
+
+#ifndef LATENCY_TRACER_RAW_HID_ID
+#  define LATENCY_TRACER_RAW_HID_ID 0xf0
+#endif
+
+#define LATENCY_TRACER_SUB_BUCKETS 4
+#define LATENCY_TRACER_BUCKETS (21 * LATENCY_TRACER_SUB_BUCKETS)
+
+typedef enum {
+  LATENCY_PATH_PLAIN,
+  LATENCY_PATH_TAP_DANCE,
+  LATENCY_PATH_FN_OVERRIDE,
+  LATENCY_PATH_LAYOUT_CONVERSION,
+  LATENCY_PATH_COUNT
+} latency_path_t;
+
+typedef enum {
+  LATENCY_TRACER_INFO = 1,
+  LATENCY_TRACER_STATS,
+  LATENCY_TRACER_BUCKETS_READ,
+  LATENCY_TRACER_RESET,
+} latency_tracer_command_t;
+
+#ifdef LATENCY_TRACER_ENABLE
+
+// pre_process_record_kb
+void latency_tracer_key_event(uint16_t keycode, keyrecord_t *record);
+// process_record_kb
+void latency_tracer_process_record(uint16_t keycode, keyrecord_t *record);
+void latency_tracer_set_path(latency_path_t path);
+// tap_dance.c, record of the resolved keycode before it is processed
+void latency_tracer_tap_dance_resolved(keyrecord_t *record);
+// post_process_record_kb
+void latency_tracer_finish(void);
+// housekeeping_task_kb
+void latency_tracer_task(void);
+bool latency_tracer_raw_hid_receive(uint8_t *data, uint8_t length);
+
+// tags the event being processed with path when process returns false (key was taken over)
+#  define LATENCY_TRACE_PATH(process, path) ((process) || (latency_tracer_set_path(path), false))
+
+#else
+
+#  define LATENCY_TRACE_PATH(process, path) (process)
+
+#endif
@@ -103,33 +103,58 @@ uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) {
 void keyboard_post_init_kb(void) {
   tap_dance_actions_init();
   keyboard_post_init_user();
-#if defined(MAC_BASE_LAYER) && defined(NON_MAC_BASE_LAYER)
-  default_layer_set(custom_config_mac_is_enable() ? (1 << MAC_BASE_LAYER)
-                                                  : (1 << NON_MAC_BASE_LAYER));
-#endif
+  custom_config_mac_update_default_layer();
 }
 
 void os_fingerprint_update_kb(os_variant_t os) {
   if (custom_config_auto_detect_is_enable()) {
-    custom_config_mac_set_enable(os == DARWIN);
+    custom_config_mac_set_enable(os_variant_is_darwin(os));
   }
 }
 
 bool process_record_kb(uint16_t keycode, keyrecord_t *record) {
+#ifdef LATENCY_TRACER_ENABLE
+  latency_tracer_process_record(keycode, record);
+#endif
   return process_record_user(keycode, record) && proces_extra_keys(keycode, record) &&
          process_tap_dance_store_event(keycode, record) &&
-         process_record_custom_config(keycode, record) && process_apple_fn(keycode, record) &&
+         process_record_custom_config(keycode, record) &&
+         LATENCY_TRACE_PATH(process_apple_fn(keycode, record), LATENCY_PATH_FN_OVERRIDE) &&
 #ifdef RADIAL_CONTROLLER_ENABLE
          process_radial_controller(keycode, record) &&
 #endif
-         process_jis_util(keycode, record);
+         LATENCY_TRACE_PATH(process_jis_util(keycode, record), LATENCY_PATH_LAYOUT_CONVERSION);
+}
+
+#ifdef LATENCY_TRACER_ENABLE
+
+bool pre_process_record_kb(uint16_t keycode, keyrecord_t *record) {
+  latency_tracer_key_event(keycode, record);
+  return pre_process_record_user(keycode, record);
+}
+
+void post_process_record_kb(uint16_t keycode, keyrecord_t *record) {
+  post_process_record_user(keycode, record);
+  latency_tracer_finish();
 }
 
+void housekeeping_task_kb(void) {
+  latency_tracer_task();
+  housekeeping_task_user();
+}
+
+#endif
+
 __attribute__((weak)) bool raw_hid_receive_user(uint8_t *data, uint8_t length) { return true; }
 __attribute__((weak)) void via_raw_hid_post_receive_user(uint8_t *data, uint8_t length) {}
 
 void raw_hid_receive(uint8_t *data, uint8_t length) {
   if (custom_config_raw_hid_is_enable()) {
+#ifdef LATENCY_TRACER_ENABLE
+    if (latency_tracer_raw_hid_receive(data, length)) {
+      return;
+    }
+#endif
     if (raw_hid_receive_user(data, length)) {
       via_raw_hid_receive(data, length);
       via_raw_hid_post_receive_user(data, length);
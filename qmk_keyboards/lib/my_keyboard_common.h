@@ -20,6 +20,7 @@
 #include "custom_config.h"
 #include "custom_keycodes.h"
 #include "jis_util.h"
+#include "latency_tracer.h"
 #ifdef RADIAL_CONTROLLER_ENABLE
 #  include "radial_controller.h"
 #endif
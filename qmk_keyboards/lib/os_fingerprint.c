@@ -25,9 +25,48 @@
 #  define OS_FINGERPRINT_TIMEOUT_MILLIS 1000
 #endif
 
+// quiet time before notifying once the os is decided
+#ifndef OS_FINGERPRINT_SETTLE_MILLIS
+#  define OS_FINGERPRINT_SETTLE_MILLIS 200
+#endif
+
 #define DTYPE_DEVICE 0x01
 #define DTYPE_CONFIG 0x02
 #define DTYPE_STRING 0x03
+#define DTYPE_DEVICE_QUALIFIER 0x06
+#define DTYPE_HID_REPORT 0x22
+
+// wLength depends on our descriptors, not on the host
+#define ANY 0
+
+#define SIGNATURE_MAX_REQUESTS 10
+
+typedef struct {
+  uint8_t os;
+  // {dtype, wLength}, dtype 0 terminates
+  uint8_t requests[SIGNATURE_MAX_REQUESTS][2];
+} os_signature_t;
+
+// built from resources/os_detection_data.js.
+// consecutive HID report requests (one per interface) are folded into one.
+// the LINUX signature comes from the Android 13 capture only, desktop linux is not covered.
+// clang-format off
+static const os_signature_t PROGMEM signatures[] = {
+  {MACOS, {{DTYPE_DEVICE, 0x08}, {DTYPE_DEVICE, 0x12},
+           {DTYPE_STRING, 0x02}, {DTYPE_STRING, ANY}, {DTYPE_STRING, 0x02}, {DTYPE_STRING, ANY},
+           {DTYPE_CONFIG, 0x09}, {DTYPE_CONFIG, ANY}, {DTYPE_HID_REPORT, ANY}, {DTYPE_STRING, ANY}}},
+  {IOS,   {{DTYPE_DEVICE, 0x08}, {DTYPE_DEVICE, 0x12},
+           {DTYPE_STRING, 0x02}, {DTYPE_STRING, ANY}, {DTYPE_STRING, 0x02}, {DTYPE_STRING, ANY},
+           {DTYPE_CONFIG, 0x09}, {DTYPE_CONFIG, ANY}, {DTYPE_HID_REPORT, ANY}}},
+  {WINDOWS, {{DTYPE_DEVICE, 0x40}, {DTYPE_DEVICE, 0x12}, {DTYPE_CONFIG, 0xff}}},
+  {LINUX,   {{DTYPE_DEVICE, 0x40}, {DTYPE_DEVICE, 0x12}, {DTYPE_DEVICE_QUALIFIER, 0x0a}}},
+};
+// clang-format on
+
+#define NUM_SIGNATURES (sizeof(signatures) / sizeof(os_signature_t))
+#define ALL_SIGNATURES ((1 << NUM_SIGNATURES) - 1)
+
+_Static_assert(NUM_SIGNATURES <= 8, "candidates bitmap is 8 bits");
 
 #ifdef OS_FINGERPRINT_DEBUG_ENABLE
 #  define NUM_DESCRIPTOR_REQUESTS 32
@@ -36,10 +75,16 @@ static uint8_t fingerprint[NUM_DESCRIPTOR_REQUESTS][2];
 
 static uint8_t request_cnt;
 static bool detecting = false;
-static uint32_t wlengths = 0;
+static uint8_t candidates;
+static uint8_t position;
+static uint8_t last_dtype;
+// darwin decided on the macOS/iOS shared prefix, the variant is refined by later requests
+static bool refining;
 static deferred_token timeout_token;
 static os_variant_t detected_os;
 
+static void classify(uint8_t dtype, uint8_t wlength);
+static os_variant_t completed_os(void);
 static uint32_t os_fingerprint_timeout_callback(uint32_t trigger_time, void *cb_arg);
 
 __attribute__((weak)) void os_fingerprint_update_kb(os_variant_t os) {}
@@ -51,7 +96,10 @@ void trace_usb_get_descriptor(const uint8_t dtype, const uint16_t w_length) {
   if (!detecting && dtype == DTYPE_DEVICE) {
     request_cnt = 0;
     detecting = true;
-    wlengths = 0;
+    candidates = ALL_SIGNATURES;
+    position = 0;
+    last_dtype = 0;
+    refining = false;
     detected_os = UNSURE;
   }
   if (detecting) {
@@ -62,28 +110,96 @@ void trace_usb_get_descriptor(const uint8_t dtype, const uint16_t w_length) {
       request_cnt++;
     }
 #endif
-    if (detected_os == UNSURE) {
-      // detect DARWIN (macOS iOS iPadOS)
-      if (dtype == DTYPE_CONFIG && (wlengths & 0xff00ff00) == 0x02000200) {
-        detected_os = DARWIN;
+    if (detected_os == UNSURE || refining) {
+      os_variant_t os = detected_os;
+      classify(dtype, wlength);
 #ifdef OS_FINGERPRINT_NOTIFY_IMMEDIATELY
+      if (detected_os != os) {
         os_fingerprint_update_kb(detected_os);
+      }
+#else
+      (void)os;
 #endif
+    }
+    // wait for the end of enumeration, shorter if the os is already known
+    uint32_t delay = detected_os != UNSURE || completed_os() != UNSURE
+                       ? OS_FINGERPRINT_SETTLE_MILLIS
+                       : OS_FINGERPRINT_TIMEOUT_MILLIS;
+    if (timeout_token) {
+      extend_deferred_exec(timeout_token, delay);
+    } else {
+      timeout_token = defer_exec(delay, os_fingerprint_timeout_callback, NULL);
+    }
+  }
+}
+
+bool os_variant_is_darwin(os_variant_t os) { return os == MACOS || os == IOS; }
+
+// local functions
+
+// drop signatures that don't match the request, decide when remaining ones agree, or on
+// darwin when only macOS and iOS are left.
+static void classify(uint8_t dtype, uint8_t wlength) {
+  if (dtype == DTYPE_HID_REPORT && last_dtype == DTYPE_HID_REPORT) {
+    return;
+  }
+  last_dtype = dtype;
+  if (!candidates) {
+    return;
+  }
+  if (position >= SIGNATURE_MAX_REQUESTS) {
+    candidates = 0;
+    return;
+  }
+  for (uint8_t i = 0; i < NUM_SIGNATURES; i++) {
+    if (candidates & (1 << i)) {
+      uint8_t sig_dtype = pgm_read_byte(&signatures[i].requests[position][0]);
+      uint8_t sig_wlength = pgm_read_byte(&signatures[i].requests[position][1]);
+      if (sig_dtype != dtype || (sig_wlength != ANY && sig_wlength != wlength)) {
+        candidates &= ~(1 << i);
       }
-      // TODO other OS
+    }
+  }
+  position++;
 
-      if (dtype == DTYPE_STRING) {
-        wlengths <<= 8;
-        wlengths += wlength & 0xff;
+  os_variant_t os = UNSURE;
+  bool agree = true;
+  bool darwin = true;
+  for (uint8_t i = 0; i < NUM_SIGNATURES; i++) {
+    if (candidates & (1 << i)) {
+      os_variant_t sig_os = pgm_read_byte(&signatures[i].os);
+      if (os != UNSURE && os != sig_os) {
+        agree = false;
       }
+      darwin = darwin && os_variant_is_darwin(sig_os);
+      os = sig_os;
     }
-    if (timeout_token) {
-      extend_deferred_exec(timeout_token, OS_FINGERPRINT_TIMEOUT_MILLIS);
-    } else {
-      timeout_token =
-        defer_exec(OS_FINGERPRINT_TIMEOUT_MILLIS, os_fingerprint_timeout_callback, NULL);
+  }
+  if (os == UNSURE) {
+    // nothing left, a darwin decision stands
+    refining = false;
+  } else if (agree) {
+    detected_os = os;
+    refining = false;
+  } else if (darwin) {
+    // callers only ask os_variant_is_darwin()
+    if (detected_os == UNSURE) {
+      detected_os = MACOS;
+    }
+    refining = true;
+  }
+}
+
+// os whose whole signature has been observed
+static os_variant_t completed_os(void) {
+  for (uint8_t i = 0; i < NUM_SIGNATURES; i++) {
+    if ((candidates & (1 << i)) &&
+        (position == SIGNATURE_MAX_REQUESTS ||
+         pgm_read_byte(&signatures[i].requests[position][0]) == 0)) {
+      return pgm_read_byte(&signatures[i].os);
     }
   }
+  return UNSURE;
 }
 
 static uint32_t os_fingerprint_timeout_callback(uint32_t trigger_time, void *cb_arg) {
@@ -95,14 +211,24 @@ static uint32_t os_fingerprint_timeout_callback(uint32_t trigger_time, void *cb_
     request_cnt++;
   }
 #endif
-  if (detected_os != UNSURE) {
-#ifndef OS_FINGERPRINT_NOTIFY_IMMEDIATELY
-    os_fingerprint_update_kb(detected_os);
-#endif
-  } else {
-    detected_os = NOT_DARWIN;
+  os_variant_t os = detected_os;
+  if (detected_os == UNSURE || refining) {
+    os_variant_t completed = completed_os();
+    if (completed != UNSURE) {
+      detected_os = completed;
+    } else if (detected_os == UNSURE) {
+      detected_os = UNKNOWN_OS;
+    }
+  }
+#ifdef OS_FINGERPRINT_NOTIFY_IMMEDIATELY
+  if (detected_os != os) {
     os_fingerprint_update_kb(detected_os);
   }
+#else
+  (void)os;
+  os_fingerprint_update_kb(detected_os);
+#endif
+  refining = false;
   detecting = false;
   timeout_token = 0;
   return 0;
@@ -110,20 +236,30 @@ static uint32_t os_fingerprint_timeout_callback(uint32_t trigger_time, void *cb_
 
 #ifdef OS_FINGERPRINT_DEBUG_ENABLE
 void send_os_fingerprint() {
-  send_string("const os_fingerprint = {\n");
-  SEND_JS_PROP_VALUE(wlengths, WORD, ",\n");
+  send_buffer_string("const os_fingerprint = {\n");
+  SEND_JS_PROP_VALUE(candidates, BYTE, ",\n");
+  SEND_JS_PROP_VALUE(position, DEC2, ",\n");
   switch (detected_os) {
     case UNSURE:
-      SEND_JS_SYMBOL_PROP_VALUE(detected_os, "'UNSURE'", STRING, ",\n");
+      SEND_JS_SYMBOL_PROP_VALUE(detected_os, "'UNSURE'", STR, ",\n");
+      break;
+    case MACOS:
+      SEND_JS_SYMBOL_PROP_VALUE(detected_os, "'MACOS'", STR, ",\n");
+      break;
+    case IOS:
+      SEND_JS_SYMBOL_PROP_VALUE(detected_os, "'IOS'", STR, ",\n");
+      break;
+    case WINDOWS:
+      SEND_JS_SYMBOL_PROP_VALUE(detected_os, "'WINDOWS'", STR, ",\n");
       break;
-    case DARWIN:
-      SEND_JS_SYMBOL_PROP_VALUE(detected_os, "'DARWIN'", STRING, ",\n");
+    case LINUX:
+      SEND_JS_SYMBOL_PROP_VALUE(detected_os, "'LINUX'", STR, ",\n");
       break;
-    case NOT_DARWIN:
-      SEND_JS_SYMBOL_PROP_VALUE(detected_os, "'NOT_DARWIN'", STRING, ",\n");
+    case UNKNOWN_OS:
+      SEND_JS_SYMBOL_PROP_VALUE(detected_os, "'UNKNOWN_OS'", STR, ",\n");
       break;
   }
   SEND_JS_PROP_2D_ARRAY(fingerprint, request_cnt, 2, BYTE, "\n");
-  send_string("}\n");
+  send_buffer_string("}\n");
 }
 #endif
@@ -16,11 +16,14 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 
-typedef enum { UNSURE, DARWIN, NOT_DARWIN } os_variant_t;
+// UNKNOWN_OS: enumeration ended without matching any signature
+typedef enum { UNSURE, MACOS, IOS, WINDOWS, LINUX, UNKNOWN_OS } os_variant_t;
 
 void os_fingerprint_update_kb(os_variant_t);
+bool os_variant_is_darwin(os_variant_t os);
 
 #ifdef OS_FINGERPRINT_DEBUG_ENABLE
 void send_os_fingerprint(void);
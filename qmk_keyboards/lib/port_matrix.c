@@ -0,0 +1,90 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// COL2ROW matrix for AVR. each strobe reads the column ports once (PINx) and assembles the
+// row with bit tests. pin lists are constant, so after unrolling, the port set and every
+// port/bit lookup is folded at compile time.
+//
+// rules.mk:
+//   CUSTOM_MATRIX = lite
+//   SRC += lib/port_matrix.c
+
+#include <quantum.h>
+
+#ifdef __AVR__
+
+#  if DIODE_DIRECTION != COL2ROW
+#    error "port_matrix.c supports COL2ROW only"
+#  endif
+
+#  define PORT_ADDRESS_COUNT 16
+#  define PIN_PORT(pin) ((pin) >> PORT_SHIFTER)
+#  define PIN_BIT(pin) _BV((pin)&0xF)
+#  define UNROLL _Pragma("GCC unroll 32")
+
+static const pin_t row_pins[MATRIX_ROWS] = MATRIX_ROW_PINS;
+static const pin_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
+
+static inline __attribute__((always_inline)) uint8_t col_port_mask(uint8_t port) {
+  uint8_t mask = 0;
+  UNROLL for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+    if (PIN_PORT(col_pins[col]) == port) {
+      mask |= PIN_BIT(col_pins[col]);
+    }
+  }
+  return mask;
+}
+
+static inline __attribute__((always_inline)) matrix_row_t read_cols(void) {
+  uint8_t ports[PORT_ADDRESS_COUNT];
+  UNROLL for (uint8_t port = 0; port < PORT_ADDRESS_COUNT; port++) {
+    if (col_port_mask(port)) {
+      ports[port] = _SFR_IO8(ADDRESS_BASE + port);
+    }
+  }
+  matrix_row_t cols = 0;
+  UNROLL for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+    if (!(ports[PIN_PORT(col_pins[col])] & PIN_BIT(col_pins[col]))) {
+      cols |= (matrix_row_t)1 << col;
+    }
+  }
+  return cols;
+}
+
+void matrix_init_custom(void) {
+  UNROLL for (uint8_t row = 0; row < MATRIX_ROWS; row++) { setPinInputHigh(row_pins[row]); }
+  UNROLL for (uint8_t col = 0; col < MATRIX_COLS; col++) { setPinInputHigh(col_pins[col]); }
+}
+
+bool matrix_scan_custom(matrix_row_t current_matrix[]) {
+  bool changed = false;
+  UNROLL for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+    setPinOutput(row_pins[row]);
+    writePinLow(row_pins[row]);
+    matrix_output_select_delay();
+    matrix_row_t cols = read_cols();
+    setPinInputHigh(row_pins[row]);
+    // columns are only pulled low through a pressed key, nothing to recover otherwise
+    if (cols) {
+      matrix_io_delay();
+    }
+    changed |= current_matrix[row] != cols;
+    current_matrix[row] = cols;
+  }
+  return changed;
+}
+
+#endif
@@ -19,23 +19,34 @@
 #include "custom_config.h"
 #include "custom_keycodes.h"
 
+// 1/10 degree per rotation
+#define DIAL_ROTATION 3600
+
 static void process_dial(int16_t direction, keyrecord_t *record);
 static void process_dial_encoder(int16_t direction);
 static void process_dial_keyswitch(int16_t direction, bool pressed);
-static void report_dial_keyswitch(void);
+static void accumulate_dial_keyswitch(void);
+static void accumulate_dial(int16_t amount);
+static bool is_fine_tune(void);
+static uint16_t accelerate(uint16_t amount, uint16_t num, uint16_t den);
+static void start_dial_service(void);
+static void send_dial(void);
 static uint32_t dial_rotation_service(uint32_t trigger_time, void *cb_arg);
 
 static report_radial_controller_t radial_controller_report;
 static int16_t rotating_direction;
 static deferred_token dial_service_token;
 static bool fine_tune;
+static int16_t dial_accumulator;  // not reported yet
+static uint16_t key_fraction;     // 1/1000 degree
+static uint16_t key_pressed_time;
+static uint16_t last_click_time;
 
 bool process_radial_controller(uint16_t keycode, keyrecord_t *record) {
   switch (keycode) {
     case RC_BTN:
       radial_controller_report.button = record->event.pressed;
-      radial_controller_report.dial = 0;
-      host_radial_controller_send(&radial_controller_report);
+      send_dial();
       return false;
     case RC_CCW:
       process_dial(-1, record);
@@ -60,13 +71,17 @@ static void process_dial(int16_t direction, keyrecord_t *record) {
 }
 
 static void process_dial_encoder(int16_t direction) {
-  uint16_t amount = 3600 / custom_config_rc_get_encoder_clicks();
-  if (fine_tune || custom_config_rc_is_fine_tune_mods_now()) {
+  uint16_t amount = DIAL_ROTATION / custom_config_rc_get_encoder_clicks();
+  uint16_t elapsed = timer_elapsed(last_click_time);
+  last_click_time = timer_read();
+  if (is_fine_tune()) {
     amount >>= custom_config_rc_get_fine_tune_ratio();
+  } else if (elapsed < RADIAL_CONTROLLER_ACCEL_CLICK_MILLIS) {
+    amount = accelerate(amount, RADIAL_CONTROLLER_ACCEL_CLICK_MILLIS - elapsed,
+                        RADIAL_CONTROLLER_ACCEL_CLICK_MILLIS);
   }
-  radial_controller_report.dial = direction * amount;
-  host_radial_controller_send(&radial_controller_report);
-  radial_controller_report.dial = 0;
+  accumulate_dial(direction * amount);
+  start_dial_service();
 }
 
 static void process_dial_keyswitch(int16_t direction, bool pressed) {
@@ -83,25 +98,75 @@ static void process_dial_keyswitch(int16_t direction, bool pressed) {
   }
   if (pressed && direction) {
     rotating_direction = direction;
+    key_pressed_time = timer_read();
+    key_fraction = 0;
   } else if (cw && !ccw) {
     rotating_direction = 1;
   } else if (!cw && ccw) {
     rotating_direction = -1;
   } else {
+    // remaining rotation is reported by the service
     rotating_direction = 0;
-    if (dial_service_token) {
-      cancel_deferred_exec(dial_service_token);
-      dial_service_token = 0;
-    }
     return;
   }
   if (!dial_service_token) {
-    report_dial_keyswitch();
+    accumulate_dial_keyswitch();
+    start_dial_service();
+  }
+}
+
+// rotation for one report interval while key is pressed
+static void accumulate_dial_keyswitch() {
+  uint16_t speed = custom_config_rc_get_key_angular_speed();
+  if (is_fine_tune()) {
+    speed >>= custom_config_rc_get_fine_tune_ratio();
+  } else {
+    uint16_t held = timer_elapsed(key_pressed_time);
+    speed = accelerate(speed, MIN(held, RADIAL_CONTROLLER_ACCEL_KEY_MILLIS),
+                       RADIAL_CONTROLLER_ACCEL_KEY_MILLIS);
+  }
+  // degree/sec * millis = 1/1000 degree
+  key_fraction += speed * RADIAL_CONTROLLER_REPORT_INTERVAL_MILLIS;
+  accumulate_dial(rotating_direction * (int16_t)(key_fraction / 100));
+  key_fraction %= 100;
+}
+
+static void accumulate_dial(int16_t amount) {
+  int32_t dial = (int32_t)dial_accumulator + amount;
+  dial_accumulator = dial > INT16_MAX ? INT16_MAX : dial < INT16_MIN ? INT16_MIN : dial;
+}
+
+static bool is_fine_tune() { return fine_tune || custom_config_rc_is_fine_tune_mods_now(); }
+
+// amount * (1 + acceleration * num / den)
+static uint16_t accelerate(uint16_t amount, uint16_t num, uint16_t den) {
+  uint32_t accelerated =
+    amount + (uint32_t)amount * custom_config_rc_get_acceleration() * num / den;
+  return accelerated > DIAL_ROTATION ? DIAL_ROTATION : accelerated;
+}
+
+static void start_dial_service() {
+  if (!dial_service_token) {
+    // first report goes immediately, following ones are coalesced
+    send_dial();
     dial_service_token =
       defer_exec(RADIAL_CONTROLLER_REPORT_INTERVAL_MILLIS, &dial_rotation_service, NULL);
   }
 }
 
+static void send_dial() {
+  int16_t dial = dial_accumulator;
+  if (dial > DIAL_ROTATION) {
+    dial = DIAL_ROTATION;
+  } else if (dial < -DIAL_ROTATION) {
+    dial = -DIAL_ROTATION;
+  }
+  radial_controller_report.dial = dial;
+  host_radial_controller_send(&radial_controller_report);
+  radial_controller_report.dial = 0;
+  dial_accumulator -= dial;
+}
+
 /**
  * @typedef Callback to execute.
  * @param trigger_time[in] the intended trigger time to execute the callback -- equivalent
@@ -112,24 +177,15 @@ static void process_dial_keyswitch(int16_t direction, bool pressed) {
  */
 static uint32_t dial_rotation_service(uint32_t trigger_time, void *cb_arg) {
   if (rotating_direction) {
-    report_dial_keyswitch();
+    accumulate_dial_keyswitch();
+  }
+  if (dial_accumulator) {
+    send_dial();
+    return RADIAL_CONTROLLER_REPORT_INTERVAL_MILLIS;
+  }
+  if (rotating_direction) {
     return RADIAL_CONTROLLER_REPORT_INTERVAL_MILLIS;
   }
   dial_service_token = 0;
   return 0;
 }
-
-static void report_dial_keyswitch() {
-  int16_t speed =
-    custom_config_rc_get_key_angular_speed() * RADIAL_CONTROLLER_REPORT_INTERVAL_MILLIS / 100;
-  if (speed > 3600) {
-    speed = 3600;
-  }
-  // 1/4 fine speed
-  if (fine_tune || custom_config_rc_is_fine_tune_mods_now()) {
-    speed >>= custom_config_rc_get_fine_tune_ratio();
-  }
-  radial_controller_report.dial = rotating_direction * speed;
-  host_radial_controller_send(&radial_controller_report);
-  radial_controller_report.dial = 0;
-}
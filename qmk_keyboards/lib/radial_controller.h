@@ -19,6 +19,17 @@
 
 #include <quantum.h>
 
-#define RADIAL_CONTROLLER_REPORT_INTERVAL_MILLIS 100
+// encoder deltas and key rotation are accumulated and reported at this interval
+#ifndef RADIAL_CONTROLLER_REPORT_INTERVAL_MILLIS
+#  define RADIAL_CONTROLLER_REPORT_INTERVAL_MILLIS 10
+#endif
+// encoder clicks slower than this are not accelerated
+#ifndef RADIAL_CONTROLLER_ACCEL_CLICK_MILLIS
+#  define RADIAL_CONTROLLER_ACCEL_CLICK_MILLIS 100
+#endif
+// key press reaches full acceleration after this time
+#ifndef RADIAL_CONTROLLER_ACCEL_KEY_MILLIS
+#  define RADIAL_CONTROLLER_ACCEL_KEY_MILLIS 1000
+#endif
 
 bool process_radial_controller(uint16_t keycode, keyrecord_t *record);
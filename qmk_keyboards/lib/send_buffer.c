@@ -0,0 +1,203 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "send_buffer.h"
+
+#ifdef SEND_STRING_ENABLE
+
+#  include <deferred_exec.h>
+#  include <send_string.h>
+
+// must be power of 2
+#  ifndef SEND_BUFFER_SIZE
+#    ifdef __AVR__
+#      define SEND_BUFFER_SIZE 128
+#    else
+#      define SEND_BUFFER_SIZE 1024
+#    endif
+#  endif
+
+// max keys per frame when NKRO is active
+#  ifndef SEND_BUFFER_NKRO_FRAME_KEYS
+#    define SEND_BUFFER_NKRO_FRAME_KEYS 16
+#  endif
+
+// interval between press and release reports
+#  ifndef SEND_BUFFER_INTERVAL_MILLIS
+#    define SEND_BUFFER_INTERVAL_MILLIS 1
+#  endif
+
+#  if SEND_BUFFER_NKRO_FRAME_KEYS > KEYBOARD_REPORT_KEYS
+#    define FRAME_KEYS_MAX SEND_BUFFER_NKRO_FRAME_KEYS
+#  else
+#    define FRAME_KEYS_MAX KEYBOARD_REPORT_KEYS
+#  endif
+
+#  define BUFFER_MASK (SEND_BUFFER_SIZE - 1)
+
+_Static_assert((SEND_BUFFER_SIZE & BUFFER_MASK) == 0, "SEND_BUFFER_SIZE must be power of 2");
+
+static char buffer[SEND_BUFFER_SIZE];
+static uint16_t head;  // read position
+static uint16_t tail;  // write position
+static uint8_t frame_keys[FRAME_KEYS_MAX];
+static uint8_t frame_len;
+static uint8_t frame_mods;
+static bool pending_space;  // dead key needs following space
+static deferred_token send_buffer_token;
+
+static uint32_t send_buffer_task(uint32_t trigger_time, void *cb_arg);
+
+static inline uint16_t buffer_count(void) { return (uint16_t)(tail - head); }
+
+static uint8_t frame_capacity(void) {
+#  ifdef NKRO_ENABLE
+  if (keyboard_protocol && keymap_config.nkro) {
+    return SEND_BUFFER_NKRO_FRAME_KEYS;
+  }
+#  endif
+  return KEYBOARD_REPORT_KEYS;
+}
+
+static uint8_t lookup_char(uint8_t ascii, uint8_t *mods, bool *dead) {
+  if (ascii >= 128) {
+    return KC_NO;
+  }
+  *mods = (PGM_LOADBIT(ascii_to_shift_lut, ascii) ? MOD_BIT(KC_LSFT) : 0) |
+          (PGM_LOADBIT(ascii_to_altgr_lut, ascii) ? MOD_BIT(KC_RALT) : 0);
+  *dead = PGM_LOADBIT(ascii_to_dead_lut, ascii);
+  return pgm_read_byte(&ascii_to_keycode_lut[ascii]);
+}
+
+// collect keys from the buffer while they can be pressed at once.
+// keys must be ascending, because hosts process a report in usage order not in pressed order.
+static bool press_frame(void) {
+  uint8_t capacity = frame_capacity();
+  frame_len = 0;
+  if (pending_space) {
+    pending_space = false;
+    frame_mods = 0;
+    frame_keys[frame_len++] = KC_SPC;
+  }
+  while (!frame_len || (frame_len < capacity && !pending_space)) {
+    if (head == tail) {
+      break;
+    }
+    uint8_t mods;
+    bool dead;
+    uint8_t keycode = lookup_char(buffer[head & BUFFER_MASK], &mods, &dead);
+    if (keycode == KC_NO) {
+      head++;
+      continue;
+    }
+    if (frame_len == 0) {
+      frame_mods = mods;
+    } else if (mods != frame_mods || keycode <= frame_keys[frame_len - 1]) {
+      break;
+    }
+    frame_keys[frame_len++] = keycode;
+    head++;
+    pending_space = dead;
+  }
+  if (frame_len == 0) {
+    return false;
+  }
+  add_weak_mods(frame_mods);
+  for (uint8_t i = 0; i < frame_len; i++) {
+    add_key(frame_keys[i]);
+  }
+  send_keyboard_report();
+  return true;
+}
+
+static void release_frame(void) {
+  for (uint8_t i = 0; i < frame_len; i++) {
+    del_key(frame_keys[i]);
+  }
+  del_weak_mods(frame_mods);
+  send_keyboard_report();
+  frame_len = 0;
+}
+
+// returns true while the buffer has something to send
+static bool send_buffer_step(void) {
+  if (frame_len) {
+    release_frame();
+    return true;
+  }
+  return press_frame();
+}
+
+static uint32_t send_buffer_task(uint32_t trigger_time, void *cb_arg) {
+  if (send_buffer_step()) {
+    return SEND_BUFFER_INTERVAL_MILLIS;
+  }
+  send_buffer_token = 0;
+  return 0;
+}
+
+void send_buffer_char(char c) {
+  while (buffer_count() >= SEND_BUFFER_SIZE) {
+    // buffer full, type synchronously until a slot is free
+    send_buffer_step();
+  }
+  buffer[tail++ & BUFFER_MASK] = c;
+  if (!send_buffer_token) {
+    send_buffer_token = defer_exec(SEND_BUFFER_INTERVAL_MILLIS, send_buffer_task, NULL);
+  }
+}
+
+void send_buffer_string(const char *str) {
+  while (*str) {
+    send_buffer_char(*str++);
+  }
+}
+
+void send_buffer_dec(uint32_t value) {
+  char buf[10];
+  uint8_t i = sizeof(buf);
+  do {
+    buf[--i] = '0' + (value % 10);
+    value /= 10;
+  } while (value && i);
+  while (i < sizeof(buf)) {
+    send_buffer_char(buf[i++]);
+  }
+}
+
+void send_buffer_hex(uint32_t value, uint8_t digits) {
+  while (digits--) {
+    uint8_t nibble = (value >> (digits * 4)) & 0xf;
+    send_buffer_char(nibble < 10 ? '0' + nibble : 'A' + nibble - 10);
+  }
+}
+
+void send_buffer_bool(bool value) { send_buffer_string(value ? "true" : "false"); }
+
+bool send_buffer_is_busy(void) { return frame_len || pending_space || head != tail; }
+
+void send_buffer_cancel(void) {
+  if (send_buffer_token) {
+    cancel_deferred_exec(send_buffer_token);
+    send_buffer_token = 0;
+  }
+  if (frame_len) {
+    release_frame();
+  }
+  pending_space = false;
+  head = tail;
+}
+
+#endif  // SEND_STRING_ENABLE
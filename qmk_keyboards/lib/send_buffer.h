@@ -0,0 +1,38 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <quantum.h>
+
+/*
+ * buffered text output.
+ *
+ * text is formatted into a RAM ring buffer and typed from deferred_exec.
+ * each frame presses as many keys as the report allows, as long as the key codes are
+ * ascending (hosts process a report in usage order) and the modifiers are unchanged.
+ * one frame costs two reports (press/release) regardless of the number of characters.
+ *
+ * requires SEND_STRING_ENABLE (ascii to keycode tables) and DEFERRED_EXEC_ENABLE.
+ */
+
+void send_buffer_char(char c);
+void send_buffer_string(const char *str);
+void send_buffer_dec(uint32_t value);
+void send_buffer_hex(uint32_t value, uint8_t digits);
+void send_buffer_bool(bool value);
+
+bool send_buffer_is_busy(void);
+void send_buffer_cancel(void);
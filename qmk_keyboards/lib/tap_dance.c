@@ -16,7 +16,13 @@
 #include "tap_dance.h"
 
 #include "custom_config.h"
+#include "latency_tracer.h"
 
+#define OUTCOME(event) (1 << (event))
+#define ALL_OUTCOMES \
+  (OUTCOME(TD_SINGLE_TAP) | OUTCOME(TD_SINGLE_HOLD) | OUTCOME(TD_MULTI_TAP) | OUTCOME(TD_TAP_HOLD))
+
+static void on_tap_dance_each(tap_dance_state_t *state, tap_dance_data_t *data);
 static void on_tap_dance_finished(tap_dance_state_t *state, tap_dance_data_t *data);
 static void on_tap_dance_reset(tap_dance_state_t *state, tap_dance_data_t *data);
 
@@ -34,6 +40,10 @@ uint16_t tap_dance_get_tapping_term(uint16_t keycode, keyrecord_t *record) {
 void tap_dance_actions_init() {
   for (uint8_t i = 0; i < TAP_DANCE_ENTRIES; i++) {
     tap_dance_datas[i].index = i;
+    tap_dance_update_outcomes(i);
+    tap_dance_actions[i].fn.on_each_tap = (void (*)(tap_dance_state_t *, void *))on_tap_dance_each;
+    tap_dance_actions[i].fn.on_each_release =
+      (void (*)(tap_dance_state_t *, void *))on_tap_dance_each;
     tap_dance_actions[i].fn.on_dance_finished =
       (void (*)(tap_dance_state_t *, void *))on_tap_dance_finished;
     tap_dance_actions[i].fn.on_reset = (void (*)(tap_dance_state_t *, void *))on_tap_dance_reset;
@@ -41,6 +51,16 @@ void tap_dance_actions_init() {
   }
 }
 
+void tap_dance_update_outcomes(uint8_t index) {
+  uint8_t outcomes = 0;
+  for (tap_dance_event_t event = TD_SINGLE_TAP; event <= TD_TAP_HOLD; event++) {
+    if (dynamic_tap_dance_keycode(index, event)) {
+      outcomes |= OUTCOME(event);
+    }
+  }
+  tap_dance_datas[index].outcomes = outcomes;
+}
+
 bool process_tap_dance_store_event(uint16_t keycode, keyrecord_t *record) {
   uint16_t index = keycode - QK_TAP_DANCE;
   if (index < TAP_DANCE_ENTRIES) {
@@ -49,19 +69,61 @@ bool process_tap_dance_store_event(uint16_t keycode, keyrecord_t *record) {
   return true;
 }
 
-static void on_tap_dance_finished(tap_dance_state_t *state, tap_dance_data_t *data) {
+static tap_dance_event_t current_event(tap_dance_state_t *state) {
   if (state->count == 1) {
-    data->event = state->pressed ? TD_SINGLE_HOLD : TD_SINGLE_TAP;
+    return state->pressed ? TD_SINGLE_HOLD : TD_SINGLE_TAP;
   } else if (state->count >= 2) {
-    data->event = state->pressed ? TD_TAP_HOLD : TD_MULTI_TAP;
-  } else {
-    data->event = TD_UNKNOWN;
+    return state->pressed ? TD_TAP_HOLD : TD_MULTI_TAP;
+  }
+  return TD_UNKNOWN;
+}
+
+// events the dance can still end with, including the current one
+static uint8_t reachable_outcomes(tap_dance_state_t *state) {
+  if (state->count == 1) {
+    return state->pressed ? ALL_OUTCOMES : ALL_OUTCOMES & ~OUTCOME(TD_SINGLE_HOLD);
+  }
+  return OUTCOME(TD_MULTI_TAP) | OUTCOME(TD_TAP_HOLD);
+}
+
+// on each press and release. when no other outcome with a keycode is reachable, waiting for
+// the tapping term can't change the result, the dance is finished now.
+static void on_tap_dance_each(tap_dance_state_t *state, tap_dance_data_t *data) {
+  if (state->finished ||
+      (data->outcomes & reachable_outcomes(state) & ~OUTCOME(current_event(state)))) {
+    return;
+  }
+  // same as process_tap_dance_action_on_dance_finished() in QMK, mods captured on the tap
+  // apply to the resolved keycode
+  state->finished = true;
+#ifndef NO_ACTION_ONESHOT
+  add_mods(state->oneshot_mods);
+#endif
+  add_weak_mods(state->weak_mods);
+  send_keyboard_report();
+  on_tap_dance_finished(state, data);
+}
+
+static void on_tap_dance_finished(tap_dance_state_t *state, tap_dance_data_t *data) {
+  data->event = current_event(state);
+  // interrupted by another key press while held (QMK interrupts the dance on the press, so this
+  // is hold-on-other-key-press, not permissive hold): the hold only when it has a keycode,
+  // otherwise the tap.
+  if (state->interrupted && !(data->outcomes & OUTCOME(data->event))) {
+    if (data->event == TD_SINGLE_HOLD) {
+      data->event = TD_SINGLE_TAP;
+    } else if (data->event == TD_TAP_HOLD) {
+      data->event = TD_MULTI_TAP;
+    }
   }
   uint16_t keycode = dynamic_tap_dance_keycode(data->index, data->event);
   if (keycode) {
     data->record.keycode = keycode;
     data->record.event.pressed = true;
     data->record.event.time = timer_read();
+#ifdef LATENCY_TRACER_ENABLE
+    latency_tracer_tap_dance_resolved(&data->record);
+#endif
     process_record(&data->record);
   }
 }
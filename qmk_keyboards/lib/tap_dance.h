@@ -39,8 +39,10 @@ typedef struct {
   uint16_t index;
   tap_dance_event_t event;
   keyrecord_t record;
+  uint8_t outcomes;  // bit per tap_dance_event_t that has a keycode
 } tap_dance_data_t;
 
 uint16_t tap_dance_get_tapping_term(uint16_t keycode, keyrecord_t *record);
 void tap_dance_actions_init(void);
+void tap_dance_update_outcomes(uint8_t index);
 bool process_tap_dance_store_event(uint16_t keycode, keyrecord_t *record);
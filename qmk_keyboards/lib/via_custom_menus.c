@@ -243,6 +243,9 @@ static void via_custom_rc_get_value(via_custom_command_t *command) {
                                         ? 1
                                         : 0);
       break;
+    case id_custom_rc_acceleration:
+      via_write_dropdown_value(command, rc_config.acceleration);
+      break;
   }
 }
 
@@ -266,6 +269,9 @@ static void via_custom_rc_set_value(via_custom_command_t *command) {
       }
       break;
     }
+    case id_custom_rc_acceleration:
+      rc_config.acceleration = via_read_dropdown_value(command);
+      break;
   }
   defer_eeprom_update_dword(id_custom_rc_channel, 0, (void *)RADIAL_CONTROLLER_EEPROM_ADDR,
                             rc_config.raw);
@@ -295,6 +301,7 @@ static void via_custom_td_set_value(via_custom_command_t *command) {
     switch (command->value_id) {
       case id_custom_td_single_tap ... id_custom_td_tap_hold:
         eeprom_update_word(adrs, via_read_keycode_value(command));
+        tap_dance_update_outcomes(td_index);
         break;
       case id_custom_td_tapping_term:
         defer_eeprom_update_word(command->channel_id, command->value_id, adrs,
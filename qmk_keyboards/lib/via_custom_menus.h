@@ -50,7 +50,8 @@ enum via_custom_rc_value_id {
   id_custom_rc_fine_tune_mod_shift,
   id_custom_rc_fine_tune_mod_alt,
   id_custom_rc_fine_tune_mod_gui,
-  id_custom_rc_fine_tune_mod_apple_fn
+  id_custom_rc_fine_tune_mod_apple_fn,
+  id_custom_rc_acceleration
 };
 
 enum via_custom_td_value_id {
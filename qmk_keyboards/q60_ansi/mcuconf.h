@@ -20,3 +20,7 @@
 
 #undef STM32_I2C_USE_I2C1
 #define STM32_I2C_USE_I2C1 TRUE
+
+// rgb_matrix_incremental.c, CPU is free while the PWM page is transferred
+#undef STM32_I2C_USE_DMA
+#define STM32_I2C_USE_DMA TRUE
@@ -0,0 +1,137 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// RGB matrix driver (RGB_MATRIX_DRIVER = custom) for a single SNLED27351/CKLED2001.
+//  - flush diffs the PWM page against what was last sent and transfers only the changed
+//    register ranges.
+//  - transfers run on a separate thread. I2C uses DMA and the thread sleeps while the bus is
+//    busy, so the main loop goes back to scanning at once.
+//  - a frame is skipped when the previous one is still being transferred, the changes are
+//    picked up by the next flush.
+//  - registers of a failed transfer are sent again by the next flush.
+
+#include QMK_KEYBOARD_H
+
+#include <i2c_master.h>
+#include <snled27351.h>
+#include <string.h>
+
+#ifndef RGB_MATRIX_INCREMENTAL_TIMEOUT
+#  define RGB_MATRIX_INCREMENTAL_TIMEOUT 100
+#endif
+
+// unchanged registers between two changed ones that are cheaper to resend than to start a
+// new transfer (address + register byte)
+#define RANGE_MERGE_GAP 2
+#define MAX_RANGES 16
+
+_Static_assert(SNLED27351_DRIVER_COUNT == 1, "single driver only");
+
+typedef struct {
+  uint8_t start;
+  uint8_t len;
+} pwm_range_t;
+
+static uint8_t pwm[SNLED27351_PWM_REGISTER_COUNT];
+// owned by the flush thread while busy
+static uint8_t sent[SNLED27351_PWM_REGISTER_COUNT];
+// bit per register that failed to transfer, resent by the next flush
+static uint8_t stale[(SNLED27351_PWM_REGISTER_COUNT + 7) / 8];
+static pwm_range_t ranges[MAX_RANGES];
+static uint8_t range_count;
+static volatile bool busy;
+// register address + data, static to keep it off the thread stack
+static uint8_t tx_buffer[1 + SNLED27351_PWM_REGISTER_COUNT];
+
+static BSEMAPHORE_DECL(flush_sem, true);
+static THD_WORKING_AREA(waFlushThread, 256);
+
+static inline bool is_stale(uint8_t reg) { return stale[reg / 8] & (1 << (reg % 8)); }
+
+static THD_FUNCTION(FlushThread, arg) {
+  (void)arg;
+  chRegSetThreadName("rgb_flush");
+  for (;;) {
+    chBSemWait(&flush_sem);
+    for (uint8_t i = 0; i < range_count; i++) {
+      pwm_range_t *range = &ranges[i];
+      tx_buffer[0] = range->start;
+      memcpy(&tx_buffer[1], &sent[range->start], range->len);
+      if (i2c_transmit(SNLED27351_I2C_ADDRESS_1 << 1, tx_buffer, range->len + 1,
+                       RGB_MATRIX_INCREMENTAL_TIMEOUT) != I2C_STATUS_SUCCESS) {
+        for (uint8_t reg = range->start; reg < range->start + range->len; reg++) {
+          stale[reg / 8] |= 1 << (reg % 8);
+        }
+      }
+    }
+    busy = false;
+  }
+}
+
+static void init(void) {
+  snled27351_init_drivers();
+  // PWM page stays selected from here on
+  snled27351_select_page(0, SNLED27351_COMMAND_PWM);
+  chThdCreateStatic(waFlushThread, sizeof(waFlushThread), NORMALPRIO + 1, FlushThread, NULL);
+}
+
+static void set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+  ckled2001_led led;
+  memcpy_P(&led, &g_ckled2001_leds[index], sizeof(led));
+  pwm[led.r] = red;
+  pwm[led.g] = green;
+  pwm[led.b] = blue;
+}
+
+static void set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
+  for (int i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+    set_color(i, red, green, blue);
+  }
+}
+
+static void flush(void) {
+  if (busy) {
+    return;
+  }
+  range_count = 0;
+  pwm_range_t *range = NULL;
+  for (uint8_t reg = 0; reg < SNLED27351_PWM_REGISTER_COUNT; reg++) {
+    if (pwm[reg] == sent[reg] && !is_stale(reg)) {
+      continue;
+    }
+    sent[reg] = pwm[reg];
+    stale[reg / 8] &= ~(1 << (reg % 8));
+    if (range != NULL &&
+        (reg - (range->start + range->len) <= RANGE_MERGE_GAP || range_count == MAX_RANGES)) {
+      range->len = reg - range->start + 1;
+    } else {
+      range = &ranges[range_count++];
+      range->start = reg;
+      range->len = 1;
+    }
+  }
+  if (range_count) {
+    busy = true;
+    chBSemSignal(&flush_sem);
+  }
+}
+
+const rgb_matrix_driver_t rgb_matrix_driver = {
+  .init = init,
+  .flush = flush,
+  .set_color = set_color,
+  .set_color_all = set_color_all,
+};
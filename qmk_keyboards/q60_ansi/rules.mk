@@ -3,6 +3,12 @@
 #
 DIP_SWITCH_ENABLE = yes
 RGB_MATRIX_ENABLE = yes
+# snled27351 through rgb_matrix_incremental.c
+RGB_MATRIX_DRIVER = custom
+I2C_DRIVER_REQUIRED = yes
+COMMON_VPATH += $(DRIVER_PATH)/led
+SRC += snled27351.c
+SRC += rgb_matrix_incremental.c
 
 # debounce
 DEBOUNCE_TYPE = sym_eager_pk
@@ -36,3 +36,4 @@ SRC += lib/alternate_device_descriptor.c
 SRC += lib/tap_dance.c
 SRC += lib/via_custom_menus.c
 SRC += lib/os_fingerprint.c
+SRC += lib/send_buffer.c
@@ -0,0 +1,125 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "custom_config.h"
+#include "custom_keycodes.h"
+#include "mock.h"
+
+/*
+ * pushes synthetic key events through process_record_kb() and reports ns/event.
+ *
+ *   ./build/bench_process_record [events]
+ *
+ * each scenario presses and releases keys of its own keycode set in turn, so that every
+ * keycode sees balanced press/release events. a held key (fn) is pressed once before the
+ * loop. host side effects only go to the mock event log.
+ */
+
+typedef struct {
+  const char *name;
+  const uint16_t *keycodes;
+  uint8_t len;
+  uint16_t held;  // KC_NO: none
+  bool mac;
+  bool usj;
+} scenario_t;
+
+static const uint16_t alpha_keys[] = {KC_A, KC_S, KC_D, KC_F, KC_J, KC_K, KC_L, KC_SCLN,
+                                      KC_Q, KC_W, KC_E, KC_R, KC_U, KC_I, KC_O, KC_P};
+static const uint16_t fkeys[] = {KC_F1, KC_F2, KC_F3, KC_F4,  KC_F5,  KC_F6,
+                                 KC_F7, KC_F8, KC_F9, KC_F10, KC_F11, KC_F12};
+static const uint16_t number_keys[] = {KC_1, KC_2, KC_3, KC_4, KC_5, KC_6,
+                                       KC_7, KC_8, KC_9, KC_0, KC_MINS, KC_EQL};
+static const uint16_t usj_keys[] = {KC_2, KC_6, KC_7, KC_8, KC_9, KC_0, KC_MINS, KC_EQL,
+                                    KC_LBRC, KC_RBRC, KC_BSLS, KC_SCLN, KC_QUOT, KC_GRV};
+static const uint16_t cursor_keys[] = {KC_UP, KC_DOWN, KC_LEFT, KC_RGHT, KC_BSPC};
+
+#define SCENARIO(name, keys, held, mac, usj) {name, keys, sizeof(keys) / 2, held, mac, usj}
+
+static const scenario_t scenarios[] = {
+  SCENARIO("alpha", alpha_keys, KC_NO, true, false),
+  SCENARIO("alpha, usj", alpha_keys, KC_NO, true, true),
+  SCENARIO("usj conversion", usj_keys, KC_NO, true, true),
+  SCENARIO("mac fn + number row", number_keys, APPLE_FF, true, false),
+  SCENARIO("non-mac fn + F-keys", fkeys, APPLE_FN, false, false),
+  SCENARIO("non-mac fn + cursor", cursor_keys, APPLE_FN, false, false),
+};
+
+static keyrecord_t record_of(uint16_t keycode, bool pressed) {
+  return (keyrecord_t){
+    .event =
+      {
+        .key = {.col = keycode & 0xFF, .row = keycode >> 8},
+        .time = timer_read(),
+        .type = KEY_EVENT,
+        .pressed = pressed,
+      },
+  };
+}
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void run(const scenario_t *scenario, uint32_t events) {
+  mock_init();
+  custom_config_mac_set_enable(scenario->mac);
+  custom_config_usj_set_enable(scenario->usj);
+  if (scenario->held) {
+    keyrecord_t record = record_of(scenario->held, true);
+    process_record(&record);
+  }
+
+  // press and release records of each keycode, built before timing
+  keyrecord_t records[64];
+  uint8_t num_records = scenario->len * 2;
+  for (uint8_t i = 0; i < scenario->len; i++) {
+    records[i * 2] = record_of(scenario->keycodes[i], true);
+    records[i * 2 + 1] = record_of(scenario->keycodes[i], false);
+  }
+
+  uint32_t handled = 0;
+  uint64_t start = now_ns();
+  for (uint32_t n = 0, i = 0; n < events; n++) {
+    // fresh copy per event like QMK, lib writes record->keycode of overridden keys
+    keyrecord_t record = records[i];
+    handled += !process_record_kb(scenario->keycodes[i >> 1], &record);
+    if (++i == num_records) {
+      i = 0;
+    }
+  }
+  uint64_t elapsed = now_ns() - start;
+
+  printf("%-24s %8.1f ns/event  (%u events, %u handled by lib)\n", scenario->name,
+         (double)elapsed / events, events, handled);
+}
+
+int main(int argc, char **argv) {
+  uint32_t events = argc > 1 ? strtoul(argv[1], NULL, 0) : 5000000;
+  if (!events) {
+    fprintf(stderr, "usage: %s [events]\n", argv[0]);
+    return 1;
+  }
+  for (uint8_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+    run(&scenarios[i], events);
+  }
+  return 0;
+}
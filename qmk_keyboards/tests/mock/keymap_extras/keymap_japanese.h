@@ -0,0 +1,44 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <quantum.h>
+
+// subset used by jis_util.c, same values as QMK
+#define JP_EISU KC_CAPS
+#define JP_CIRC KC_EQL
+#define JP_YEN KC_INT3
+#define JP_AT KC_LBRC
+#define JP_LBRC KC_RBRC
+#define JP_COLN KC_QUOT
+#define JP_RBRC KC_NUHS
+#define JP_BSLS KC_INT1
+
+#define JP_DQUO S(KC_2)
+#define JP_AMPR S(KC_6)
+#define JP_QUOT S(KC_7)
+#define JP_LPRN S(KC_8)
+#define JP_RPRN S(KC_9)
+#define JP_EQL S(KC_MINS)
+#define JP_TILD S(JP_CIRC)
+#define JP_PIPE S(JP_YEN)
+#define JP_GRV S(JP_AT)
+#define JP_LCBR S(JP_LBRC)
+#define JP_PLUS S(KC_SCLN)
+#define JP_ASTR S(JP_COLN)
+#define JP_RCBR S(JP_RBRC)
+#define JP_UNDS S(JP_BSLS)
+#define JP_CAPS S(JP_EISU)
@@ -0,0 +1,504 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "mock.h"
+
+#include <assert.h>
+#include <deferred_exec.h>
+#include <eeprom.h>
+#include <via.h>
+
+#define EEPROM_SIZE 2048
+#define DEFERRED_EXEC_SLOTS 8
+// longest time mock_init() waits for deferred executors left by the previous test
+#define FLUSH_MILLIS 10000
+
+typedef struct {
+  deferred_token token;
+  uint32_t trigger_time;
+  deferred_exec_callback callback;
+  void *cb_arg;
+} deferred_slot_t;
+
+uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record);
+
+keymap_config_t keymap_config;
+
+static uint32_t now;
+static mock_event_t events[MOCK_LOG_SIZE];
+static uint16_t event_count;
+
+static uint8_t keys[32];
+static uint8_t real_mods;
+static uint8_t weak_mods;
+static uint16_t apple_usages;
+static uint32_t layer_state;
+
+static uint8_t eeprom[EEPROM_SIZE];
+static uint32_t eeconfig_kb;
+static uint16_t eeconfig_keymap;
+
+static deferred_slot_t deferred_slots[DEFERRED_EXEC_SLOTS];
+static deferred_token last_token;
+
+static tap_dance_state_t tap_dance_states[TAP_DANCE_ENTRIES];
+static uint16_t active_td;
+static uint16_t last_tap_time;
+
+static void log_event(mock_event_type_t type, uint16_t code, int16_t value) {
+  events[event_count % MOCK_LOG_SIZE] = (mock_event_t){.type = type, .code = code, .value = value};
+  // saturate, the log only keeps the last MOCK_LOG_SIZE anyway
+  if (event_count < UINT16_MAX) {
+    event_count++;
+  }
+}
+
+// weak user hooks
+//------------------------------------------
+
+__attribute__((weak)) bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+  return true;
+}
+__attribute__((weak)) bool pre_process_record_user(uint16_t keycode, keyrecord_t *record) {
+  return true;
+}
+__attribute__((weak)) void post_process_record_user(uint16_t keycode, keyrecord_t *record) {}
+__attribute__((weak)) void keyboard_pre_init_user(void) {}
+__attribute__((weak)) void keyboard_post_init_user(void) {}
+__attribute__((weak)) void eeconfig_init_user(void) {}
+__attribute__((weak)) void housekeeping_task_user(void) {}
+
+// tap dance, same order of callbacks as quantum/process_keycode/process_tap_dance.c
+//------------------------------------------
+
+static void tap_dance_call(tap_dance_user_fn_t fn, tap_dance_state_t *state, void *user_data) {
+  if (fn) {
+    fn(state, user_data);
+  }
+}
+
+static void tap_dance_reset(uint8_t index) {
+  tap_dance_state_t *state = &tap_dance_states[index];
+  tap_dance_action_t *action = &tap_dance_actions[index];
+  tap_dance_call(action->fn.on_reset, state, action->user_data);
+  del_weak_mods(state->weak_mods);
+#ifndef NO_ACTION_ONESHOT
+  del_mods(state->oneshot_mods);
+#endif
+  send_keyboard_report();
+  memset(state, 0, sizeof(*state));
+}
+
+static void tap_dance_finish(uint8_t index) {
+  tap_dance_state_t *state = &tap_dance_states[index];
+  tap_dance_action_t *action = &tap_dance_actions[index];
+  if (!state->finished) {
+    state->finished = true;
+    add_weak_mods(state->weak_mods);
+#ifndef NO_ACTION_ONESHOT
+    add_mods(state->oneshot_mods);
+#endif
+    send_keyboard_report();
+    tap_dance_call(action->fn.on_dance_finished, state, action->user_data);
+  }
+  active_td = 0;
+  if (!state->pressed) {
+    tap_dance_reset(index);
+  }
+}
+
+static void preprocess_tap_dance(uint16_t keycode, keyrecord_t *record) {
+  if (!record->event.pressed || record->keycode || !active_td || keycode == active_td) {
+    return;
+  }
+  tap_dance_state_t *state = &tap_dance_states[active_td - QK_TAP_DANCE];
+  state->interrupted = true;
+  state->interrupting_keycode = keycode;
+  tap_dance_finish(active_td - QK_TAP_DANCE);
+  weak_mods = 0;
+}
+
+static void process_tap_dance(uint16_t keycode, keyrecord_t *record) {
+  uint8_t index = keycode - QK_TAP_DANCE;
+  if (index >= TAP_DANCE_ENTRIES) {
+    return;
+  }
+  tap_dance_state_t *state = &tap_dance_states[index];
+  tap_dance_action_t *action = &tap_dance_actions[index];
+  state->pressed = record->event.pressed;
+  if (record->event.pressed) {
+    last_tap_time = timer_read();
+    state->count++;
+    state->weak_mods = real_mods | weak_mods;
+    tap_dance_call(action->fn.on_each_tap, state, action->user_data);
+    active_td = state->finished ? 0 : keycode;
+  } else {
+    tap_dance_call(action->fn.on_each_release, state, action->user_data);
+    if (state->finished) {
+      tap_dance_reset(index);
+      if (active_td == keycode) {
+        active_td = 0;
+      }
+    }
+  }
+}
+
+static void tap_dance_task(void) {
+  if (!active_td || timer_elapsed(last_tap_time) <= get_tapping_term(active_td, NULL)) {
+    return;
+  }
+  uint8_t index = active_td - QK_TAP_DANCE;
+  if (!tap_dance_states[index].interrupted) {
+    tap_dance_finish(index);
+  }
+}
+
+// actions
+//------------------------------------------
+
+// tests map each keycode to its own position, row = high byte, col = low byte
+static uint16_t keycode_at(keypos_t key) { return (uint16_t)key.row << 8 | key.col; }
+
+static uint8_t mods_of(uint16_t code) {
+  uint8_t mods = (code >> 8) & 0x0F;
+  return code & 0x1000 ? mods << 4 : mods;
+}
+
+void process_record(keyrecord_t *record) {
+  uint16_t keycode = record->keycode ? record->keycode : keycode_at(record->event.key);
+  preprocess_tap_dance(keycode, record);
+  if (!process_record_kb(keycode, record)) {
+    return;
+  }
+  bool pressed = record->event.pressed;
+  if (IS_QK_TAP_DANCE(keycode)) {
+    process_tap_dance(keycode, record);
+  } else if (keycode <= 0xFF) {
+    pressed ? register_code(keycode) : unregister_code(keycode);
+  } else if (keycode <= QK_MODS_MAX) {
+    pressed ? register_code16(keycode) : unregister_code16(keycode);
+  } else if ((keycode & ~0x1F) == QK_MOMENTARY) {
+    pressed ? layer_on(keycode & 0x1F) : layer_off(keycode & 0x1F);
+  }
+}
+
+void register_code(uint8_t code) {
+  if (IS_MODIFIER_KEYCODE(code)) {
+    real_mods |= MOD_BIT(code);
+  } else {
+    keys[code >> 3] |= 1 << (code & 7);
+  }
+  log_event(MOCK_REGISTER, code, real_mods | weak_mods);
+  send_keyboard_report();
+}
+
+void unregister_code(uint8_t code) {
+  if (IS_MODIFIER_KEYCODE(code)) {
+    real_mods &= ~MOD_BIT(code);
+  } else {
+    keys[code >> 3] &= ~(1 << (code & 7));
+  }
+  log_event(MOCK_UNREGISTER, code, real_mods | weak_mods);
+  send_keyboard_report();
+}
+
+void register_code16(uint16_t code) {
+  uint8_t basic = code & 0xFF;
+  if (IS_MODIFIER_KEYCODE(basic) || basic == KC_NO) {
+    add_mods(mods_of(code));
+  } else {
+    add_weak_mods(mods_of(code));
+  }
+  register_code(basic);
+}
+
+void unregister_code16(uint16_t code) {
+  uint8_t basic = code & 0xFF;
+  unregister_code(basic);
+  if (IS_MODIFIER_KEYCODE(basic) || basic == KC_NO) {
+    del_mods(mods_of(code));
+  } else {
+    del_weak_mods(mods_of(code));
+  }
+  send_keyboard_report();
+}
+
+void clear_keyboard(void) {
+  memset(keys, 0, sizeof(keys));
+  real_mods = 0;
+  weak_mods = 0;
+  apple_usages = 0;
+}
+
+uint8_t get_mods(void) { return real_mods; }
+void add_mods(uint8_t mods) { real_mods |= mods; }
+void del_mods(uint8_t mods) { real_mods &= ~mods; }
+uint8_t get_weak_mods(void) { return weak_mods; }
+void add_weak_mods(uint8_t mods) { weak_mods |= mods; }
+void del_weak_mods(uint8_t mods) { weak_mods &= ~mods; }
+void send_keyboard_report(void) {}
+
+void default_layer_set(uint32_t state) { log_event(MOCK_LAYER, state, 0); }
+void layer_on(uint8_t layer) { layer_state |= 1UL << layer; }
+void layer_off(uint8_t layer) { layer_state &= ~(1UL << layer); }
+
+void soft_reset_keyboard(void) { log_event(MOCK_SOFT_RESET, 0, 0); }
+
+// host
+//------------------------------------------
+
+void host_system_send(uint16_t usage) { log_event(MOCK_SYSTEM, usage, 0); }
+
+void host_consumer_send(uint16_t usage) { log_event(MOCK_CONSUMER, usage, 0); }
+
+void host_apple_send(bool pressed, uint8_t usage_index) {
+  uint16_t usages =
+    pressed ? apple_usages | (1 << usage_index) : apple_usages & ~(1 << usage_index);
+  if (usages != apple_usages) {
+    apple_usages = usages;
+    log_event(MOCK_APPLE, usage_index, pressed);
+  }
+}
+
+bool host_apple_is_pressed(uint16_t usage_mask) { return apple_usages & usage_mask; }
+
+void host_radial_controller_send(report_radial_controller_t *report) {
+  log_event(MOCK_RADIAL, report->button, report->dial);
+}
+
+bool via_eeprom_is_valid(void) { return true; }
+
+void via_raw_hid_receive(uint8_t *data, uint8_t length) {
+  if (data[0] >= id_custom_set_value && data[0] <= id_custom_save) {
+    via_custom_value_command_kb(data, length);
+  }
+}
+
+// timer
+//------------------------------------------
+
+uint16_t timer_read(void) { return now; }
+uint32_t timer_read32(void) { return now; }
+uint16_t timer_elapsed(uint16_t last) { return (uint16_t)now - last; }
+uint32_t timer_elapsed32(uint32_t last) { return now - last; }
+
+// eeprom
+//------------------------------------------
+
+static uint8_t *eeprom_at(const void *addr, size_t len) {
+  uintptr_t offset = (uintptr_t)addr;
+  assert(offset + len <= EEPROM_SIZE);
+  return &eeprom[offset];
+}
+
+uint8_t eeprom_read_byte(const uint8_t *addr) { return *eeprom_at(addr, 1); }
+
+uint16_t eeprom_read_word(const uint16_t *addr) {
+  uint16_t value;
+  memcpy(&value, eeprom_at(addr, 2), 2);
+  return value;
+}
+
+uint32_t eeprom_read_dword(const uint32_t *addr) {
+  uint32_t value;
+  memcpy(&value, eeprom_at(addr, 4), 4);
+  return value;
+}
+
+void eeprom_read_block(void *buf, const void *addr, size_t len) {
+  memcpy(buf, eeprom_at(addr, len), len);
+}
+
+void eeprom_update_byte(uint8_t *addr, uint8_t value) { *eeprom_at(addr, 1) = value; }
+void eeprom_update_word(uint16_t *addr, uint16_t value) { memcpy(eeprom_at(addr, 2), &value, 2); }
+void eeprom_update_dword(uint32_t *addr, uint32_t value) { memcpy(eeprom_at(addr, 4), &value, 4); }
+void eeprom_update_block(const void *buf, void *addr, size_t len) {
+  memcpy(eeprom_at(addr, len), buf, len);
+}
+
+uint32_t eeconfig_read_kb(void) { return eeconfig_kb; }
+void eeconfig_update_kb(uint32_t val) { eeconfig_kb = val; }
+uint16_t eeconfig_read_keymap(void) { return eeconfig_keymap; }
+void eeconfig_update_keymap(uint16_t val) { eeconfig_keymap = val; }
+
+// deferred executors
+//------------------------------------------
+
+static deferred_slot_t *find_slot(deferred_token token) {
+  for (uint8_t i = 0; token && i < DEFERRED_EXEC_SLOTS; i++) {
+    if (deferred_slots[i].token == token) {
+      return &deferred_slots[i];
+    }
+  }
+  return NULL;
+}
+
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg) {
+  deferred_slot_t *slot = NULL;
+  for (uint8_t i = 0; slot == NULL && i < DEFERRED_EXEC_SLOTS; i++) {
+    if (deferred_slots[i].token == INVALID_DEFERRED_TOKEN) {
+      slot = &deferred_slots[i];
+    }
+  }
+  if (slot == NULL || delay_ms == 0) {
+    return INVALID_DEFERRED_TOKEN;
+  }
+  do {
+    last_token++;
+  } while (last_token == INVALID_DEFERRED_TOKEN || find_slot(last_token));
+  *slot = (deferred_slot_t){
+    .token = last_token,
+    .trigger_time = now + delay_ms,
+    .callback = callback,
+    .cb_arg = cb_arg,
+  };
+  return last_token;
+}
+
+bool extend_deferred_exec(deferred_token token, uint32_t delay_ms) {
+  deferred_slot_t *slot = find_slot(token);
+  if (slot == NULL || delay_ms == 0) {
+    return false;
+  }
+  slot->trigger_time = now + delay_ms;
+  return true;
+}
+
+bool cancel_deferred_exec(deferred_token token) {
+  deferred_slot_t *slot = find_slot(token);
+  if (slot == NULL) {
+    return false;
+  }
+  slot->token = INVALID_DEFERRED_TOKEN;
+  return true;
+}
+
+static bool deferred_exec_pending(void) {
+  for (uint8_t i = 0; i < DEFERRED_EXEC_SLOTS; i++) {
+    if (deferred_slots[i].token != INVALID_DEFERRED_TOKEN) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void deferred_exec_task(void) {
+  for (uint8_t i = 0; i < DEFERRED_EXEC_SLOTS; i++) {
+    deferred_slot_t *slot = &deferred_slots[i];
+    if (slot->token == INVALID_DEFERRED_TOKEN || (int32_t)(now - slot->trigger_time) < 0) {
+      continue;
+    }
+    deferred_token token = slot->token;
+    uint32_t delay_ms = slot->callback(slot->trigger_time, slot->cb_arg);
+    // the callback may have cancelled or extended itself
+    if (slot->token == token && (int32_t)(now - slot->trigger_time) >= 0) {
+      if (delay_ms) {
+        slot->trigger_time += delay_ms;
+      } else {
+        slot->token = INVALID_DEFERRED_TOKEN;
+      }
+    }
+  }
+}
+
+// test api
+//------------------------------------------
+
+void mock_init(void) {
+  for (uint32_t i = 0; i < FLUSH_MILLIS && (deferred_exec_pending() || active_td); i++) {
+    mock_advance(1);
+  }
+  clear_keyboard();
+  layer_state = 0;
+  memset(eeprom, 0, sizeof(eeprom));
+  eeconfig_kb = 0;
+  eeconfig_keymap = 0;
+  keymap_config.raw = 0;
+  eeconfig_init_kb();
+  keyboard_pre_init_kb();
+  keyboard_post_init_kb();
+  mock_clear_log();
+}
+
+void mock_clear_log(void) { event_count = 0; }
+
+uint16_t mock_log_count(void) { return event_count; }
+
+const mock_event_t *mock_log(uint16_t i) {
+  if (i >= event_count || event_count - i > MOCK_LOG_SIZE) {
+    return NULL;
+  }
+  return &events[i % MOCK_LOG_SIZE];
+}
+
+int mock_find(uint16_t from, mock_event_type_t type, uint16_t code) {
+  for (uint16_t i = from; i < event_count; i++) {
+    const mock_event_t *event = mock_log(i);
+    if (event && event->type == type && event->code == code) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void mock_key(uint16_t keycode, bool pressed) {
+  keyrecord_t record = {
+    .event =
+      {
+        .key = {.col = keycode & 0xFF, .row = keycode >> 8},
+        .time = timer_read(),
+        .type = KEY_EVENT,
+        .pressed = pressed,
+      },
+  };
+  process_record(&record);
+}
+
+void mock_tap(uint16_t keycode) {
+  mock_key(keycode, true);
+  mock_key(keycode, false);
+}
+
+void mock_encoder(uint16_t keycode, bool clockwise) {
+  keyrecord_t record = {
+    .event =
+      {
+        .key = {.col = keycode & 0xFF, .row = keycode >> 8},
+        .time = timer_read(),
+        .type = clockwise ? ENCODER_CW_EVENT : ENCODER_CCW_EVENT,
+        .pressed = true,
+      },
+  };
+  process_record(&record);
+  record.event.pressed = false;
+  process_record(&record);
+}
+
+void mock_advance(uint32_t ms) {
+  while (ms--) {
+    now++;
+    tap_dance_task();
+    deferred_exec_task();
+  }
+}
+
+bool mock_is_pressed(uint8_t code) {
+  if (IS_MODIFIER_KEYCODE(code)) {
+    return real_mods & MOD_BIT(code);
+  }
+  return keys[code >> 3] & (1 << (code & 7));
+}
+
+uint8_t mock_eeprom_byte(uint16_t addr) { return eeprom[addr]; }
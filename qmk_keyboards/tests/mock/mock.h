@@ -0,0 +1,67 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <quantum.h>
+
+/*
+ * test side of the mock.
+ *
+ * every call into the mocked host/action APIs is appended to an event log. the clock only
+ * moves with mock_advance(), which also runs due deferred executors and the tap dance
+ * tapping term.
+ */
+
+#define MOCK_LOG_SIZE 256
+
+typedef enum {
+  MOCK_REGISTER,    // code: keycode, value: real and weak mods after the change
+  MOCK_UNREGISTER,  // code: keycode, value: real and weak mods after the change
+  MOCK_SYSTEM,      // code: usage
+  MOCK_CONSUMER,    // code: usage
+  MOCK_APPLE,       // code: usage index, value: pressed
+  MOCK_RADIAL,      // code: button, value: dial
+  MOCK_LAYER,       // code: default layer state
+  MOCK_SOFT_RESET,
+} mock_event_type_t;
+
+typedef struct {
+  mock_event_type_t type;
+  uint16_t code;
+  int16_t value;
+} mock_event_t;
+
+// clears state, log, clock, deferred executors and eeprom, then runs the keyboard init hooks
+void mock_init(void);
+// clears the event log only
+void mock_clear_log(void);
+
+uint16_t mock_log_count(void);
+// i-th event since the last clear, NULL if it fell out of the log
+const mock_event_t *mock_log(uint16_t i);
+// index of the first matching event at or after from, -1 if none
+int mock_find(uint16_t from, mock_event_type_t type, uint16_t code);
+
+// key at a position that maps to keycode, pressed at the current time
+void mock_key(uint16_t keycode, bool pressed);
+void mock_tap(uint16_t keycode);
+void mock_encoder(uint16_t keycode, bool clockwise);
+
+// moves the clock by ms, 1ms at a time
+void mock_advance(uint32_t ms);
+
+bool mock_is_pressed(uint8_t code);
+uint8_t mock_eeprom_byte(uint16_t addr);
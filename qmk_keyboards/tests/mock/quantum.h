@@ -0,0 +1,336 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+ * thin host mock of the QMK APIs used by lib/.
+ * only what lib/ calls is declared, keycode values are the same as QMK.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <deferred_exec.h>
+#include <eeprom.h>
+
+#define PROGMEM
+#define memcpy_P memcpy
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+
+#ifndef MIN
+#  define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#  define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+#ifndef TAPPING_TERM
+#  define TAPPING_TERM 200
+#endif
+
+// keycodes
+//------------------------------------------
+
+enum {
+  KC_NO = 0x00,
+  KC_A = 0x04,
+  KC_B,
+  KC_C,
+  KC_D,
+  KC_E,
+  KC_F,
+  KC_G,
+  KC_H,
+  KC_I,
+  KC_J,
+  KC_K,
+  KC_L,
+  KC_M,
+  KC_N,
+  KC_O,
+  KC_P,
+  KC_Q,
+  KC_R,
+  KC_S,
+  KC_T,
+  KC_U,
+  KC_V,
+  KC_W,
+  KC_X,
+  KC_Y,
+  KC_Z,
+  KC_1,
+  KC_2,
+  KC_3,
+  KC_4,
+  KC_5,
+  KC_6,
+  KC_7,
+  KC_8,
+  KC_9,
+  KC_0,
+  KC_ENT,
+  KC_ESC,
+  KC_BSPC,
+  KC_TAB,
+  KC_SPC,
+  KC_MINS,
+  KC_EQL,
+  KC_LBRC,
+  KC_RBRC,
+  KC_BSLS,
+  KC_NUHS,
+  KC_SCLN,
+  KC_QUOT,
+  KC_GRV,
+  KC_COMM,
+  KC_DOT,
+  KC_SLSH,
+  KC_CAPS,
+  KC_F1,
+  KC_F2,
+  KC_F3,
+  KC_F4,
+  KC_F5,
+  KC_F6,
+  KC_F7,
+  KC_F8,
+  KC_F9,
+  KC_F10,
+  KC_F11,
+  KC_F12,
+  KC_HOME = 0x4A,
+  KC_PGUP,
+  KC_DEL,
+  KC_END,
+  KC_PGDN,
+  KC_RGHT,
+  KC_LEFT,
+  KC_DOWN,
+  KC_UP,
+  KC_APP = 0x65,
+  KC_INT1 = 0x87,
+  KC_INT3 = 0x89,
+  KC_LNG1 = 0x90,
+  KC_LNG2,
+  KC_MUTE = 0xA8,
+  KC_VOLU,
+  KC_VOLD,
+  KC_MNXT,
+  KC_MPRV,
+  KC_MSTP,
+  KC_MPLY,
+  KC_BRIU = 0xBD,
+  KC_BRID,
+  KC_LCTL = 0xE0,
+  KC_LSFT,
+  KC_LALT,
+  KC_LGUI,
+  KC_RCTL,
+  KC_RSFT,
+  KC_RALT,
+  KC_RGUI,
+};
+#define KC_RIGHT KC_RGHT
+
+#define QK_LCTL 0x0100
+#define QK_LSFT 0x0200
+#define QK_LALT 0x0400
+#define QK_LGUI 0x0800
+#define QK_MODS_MAX 0x1FFF
+#define QK_MOMENTARY 0x5220
+#define QK_TAP_DANCE 0x5700
+#define QK_TAP_DANCE_MAX 0x57FF
+#define QK_KB_0 0x7E00
+
+#define C(kc) (QK_LCTL | (kc))
+#define S(kc) (QK_LSFT | (kc))
+#define A(kc) (QK_LALT | (kc))
+#define G(kc) (QK_LGUI | (kc))
+#define LALT(kc) A(kc)
+#define LAG(kc) (QK_LALT | QK_LGUI | (kc))
+#define MO(layer) (QK_MOMENTARY | ((layer)&0x1F))
+#define TD(index) (QK_TAP_DANCE | ((index)&0xFF))
+
+#define IS_QK_TAP_DANCE(code) ((code) >= QK_TAP_DANCE && (code) <= QK_TAP_DANCE_MAX)
+#define IS_MODIFIER_KEYCODE(code) ((code) >= KC_LCTL && (code) <= KC_RGUI)
+
+#define MOD_BIT(code) (1 << ((code)&0x07))
+#define MOD_MASK_CTRL (MOD_BIT(KC_LCTL) | MOD_BIT(KC_RCTL))
+#define MOD_MASK_SHIFT (MOD_BIT(KC_LSFT) | MOD_BIT(KC_RSFT))
+#define MOD_MASK_ALT (MOD_BIT(KC_LALT) | MOD_BIT(KC_RALT))
+#define MOD_MASK_GUI (MOD_BIT(KC_LGUI) | MOD_BIT(KC_RGUI))
+
+// system / consumer usages
+#define AL_LOCK 0x019E
+
+// key events
+//------------------------------------------
+
+typedef struct {
+  uint8_t col;
+  uint8_t row;
+} keypos_t;
+
+typedef enum {
+  TICK_EVENT = 0,
+  KEY_EVENT = 1,
+  ENCODER_CW_EVENT = 2,
+  ENCODER_CCW_EVENT = 3,
+} keyevent_type_t;
+
+typedef struct {
+  keypos_t key;
+  uint16_t time;
+  keyevent_type_t type;
+  bool pressed;
+} keyevent_t;
+
+typedef struct {
+  bool interrupted : 1;
+  uint8_t count : 4;
+} tap_t;
+
+typedef struct {
+  keyevent_t event;
+  tap_t tap;
+  uint16_t keycode;
+} keyrecord_t;
+
+#define KEYEQ(keya, keyb) ((keya).row == (keyb).row && (keya).col == (keyb).col)
+#define IS_ENCODEREVENT(event) \
+  ((event).type == ENCODER_CW_EVENT || (event).type == ENCODER_CCW_EVENT)
+
+void process_record(keyrecord_t *record);
+
+bool process_record_kb(uint16_t keycode, keyrecord_t *record);
+bool process_record_user(uint16_t keycode, keyrecord_t *record);
+bool pre_process_record_user(uint16_t keycode, keyrecord_t *record);
+void post_process_record_user(uint16_t keycode, keyrecord_t *record);
+void keyboard_pre_init_user(void);
+void keyboard_post_init_user(void);
+void eeconfig_init_user(void);
+void housekeeping_task_user(void);
+
+void keyboard_pre_init_kb(void);
+void keyboard_post_init_kb(void);
+void eeconfig_init_kb(void);
+void via_init_kb(void);
+
+// actions
+//------------------------------------------
+
+void register_code(uint8_t code);
+void unregister_code(uint8_t code);
+void register_code16(uint16_t code);
+void unregister_code16(uint16_t code);
+void clear_keyboard(void);
+
+uint8_t get_mods(void);
+void add_mods(uint8_t mods);
+void del_mods(uint8_t mods);
+uint8_t get_weak_mods(void);
+void add_weak_mods(uint8_t mods);
+void del_weak_mods(uint8_t mods);
+void send_keyboard_report(void);
+
+void default_layer_set(uint32_t state);
+void layer_on(uint8_t layer);
+void layer_off(uint8_t layer);
+
+void soft_reset_keyboard(void);
+
+// host
+//------------------------------------------
+
+typedef struct {
+  uint16_t button : 1;
+  int16_t dial : 15;
+} __attribute__((packed)) report_radial_controller_t;
+
+void host_system_send(uint16_t usage);
+void host_consumer_send(uint16_t usage);
+void host_apple_send(bool pressed, uint8_t usageIndex);
+bool host_apple_is_pressed(uint16_t usage_mask);
+void host_radial_controller_send(report_radial_controller_t *report);
+
+// timer
+//------------------------------------------
+
+uint16_t timer_read(void);
+uint32_t timer_read32(void);
+uint16_t timer_elapsed(uint16_t last);
+uint32_t timer_elapsed32(uint32_t last);
+
+// eeconfig
+//------------------------------------------
+
+typedef union {
+  uint16_t raw;
+  struct {
+    bool swap_control_capslock : 1;
+    bool capslock_to_control : 1;
+    bool swap_lalt_lgui : 1;
+    bool swap_ralt_rgui : 1;
+    bool no_gui : 1;
+    bool swap_grave_esc : 1;
+    bool swap_backslash_backspace : 1;
+    bool nkro : 1;
+    bool swap_lctl_lgui : 1;
+    bool swap_rctl_rgui : 1;
+    bool oneshot_enable : 1;
+    bool swap_escape_capslock : 1;
+    bool autocorrect_enable : 1;
+  };
+} keymap_config_t;
+extern keymap_config_t keymap_config;
+
+uint32_t eeconfig_read_kb(void);
+void eeconfig_update_kb(uint32_t val);
+uint16_t eeconfig_read_keymap(void);
+void eeconfig_update_keymap(uint16_t val);
+
+// tap dance
+//------------------------------------------
+
+typedef struct {
+  uint16_t interrupting_keycode;
+  uint8_t count;
+  uint8_t weak_mods;
+#ifndef NO_ACTION_ONESHOT
+  uint8_t oneshot_mods;
+#endif
+  bool pressed : 1;
+  bool finished : 1;
+  bool interrupted : 1;
+} tap_dance_state_t;
+
+typedef void (*tap_dance_user_fn_t)(tap_dance_state_t *state, void *user_data);
+
+typedef struct {
+  struct {
+    tap_dance_user_fn_t on_each_tap;
+    tap_dance_user_fn_t on_dance_finished;
+    tap_dance_user_fn_t on_reset;
+    tap_dance_user_fn_t on_each_release;
+  } fn;
+  void *user_data;
+} tap_dance_action_t;
+
+extern tap_dance_action_t tap_dance_actions[];
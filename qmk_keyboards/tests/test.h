@@ -0,0 +1,61 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdio.h>
+
+#include "mock.h"
+
+/*
+ * minimal test runner. each test starts from mock_init(), a failed expectation is reported and
+ * the test goes on, main() returns non-zero if any failed.
+ */
+
+static int test_failures;
+
+#define EXPECT_EQ(actual, expected)                                                       \
+  do {                                                                                    \
+    long long _actual = (actual), _expected = (expected);                                 \
+    if (_actual != _expected) {                                                           \
+      fprintf(stderr, "%s:%d: %s: expected %lld (0x%llx), got %lld (0x%llx)\n", __FILE__, \
+              __LINE__, #actual, _expected, _expected, _actual, _actual);                 \
+      test_failures++;                                                                    \
+    }                                                                                     \
+  } while (0)
+
+#define EXPECT_TRUE(cond) EXPECT_EQ(!!(cond), 1)
+#define EXPECT_FALSE(cond) EXPECT_EQ(!!(cond), 0)
+
+// i-th event in the log is type/code
+#define EXPECT_EVENT(i, event_type, event_code) \
+  do {                                          \
+    const mock_event_t *_event = mock_log(i);   \
+    EXPECT_TRUE(_event != NULL);                \
+    if (_event) {                               \
+      EXPECT_EQ(_event->type, (event_type));    \
+      EXPECT_EQ(_event->code, (event_code));    \
+    }                                           \
+  } while (0)
+
+#define RUN_TEST(test)                                                      \
+  do {                                                                      \
+    int _failures = test_failures;                                          \
+    mock_init();                                                            \
+    test();                                                                 \
+    printf("%s %s\n", test_failures == _failures ? "PASS" : "FAIL", #test); \
+  } while (0)
+
+#define TEST_RESULT() (test_failures ? 1 : 0)
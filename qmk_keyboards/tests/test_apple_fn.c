@@ -0,0 +1,116 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "my_keyboard_common.h"
+#include "test.h"
+
+static void non_mac_mode(void) {
+  custom_config_mac_set_enable(false);
+  mock_clear_log();
+}
+
+static void apple_fn_sends_fn_usage(void) {
+  mock_key(APPLE_FN, true);
+  EXPECT_TRUE(host_apple_is_pressed(1 << USAGE_INDEX_AVT_KEYBOARD_FN));
+  mock_key(APPLE_FN, false);
+  EXPECT_FALSE(host_apple_is_pressed(1 << USAGE_INDEX_AVT_KEYBOARD_FN));
+  EXPECT_EQ(mock_log_count(), 2);
+  EXPECT_EVENT(0, MOCK_APPLE, USAGE_INDEX_AVT_KEYBOARD_FN);
+  EXPECT_EVENT(1, MOCK_APPLE, USAGE_INDEX_AVT_KEYBOARD_FN);
+}
+
+static void apple_ff_maps_number_row_to_fkeys(void) {
+  mock_key(APPLE_FF, true);
+  mock_key(KC_1, true);
+  EXPECT_TRUE(mock_is_pressed(KC_F1));
+  EXPECT_FALSE(mock_is_pressed(KC_1));
+  mock_key(APPLE_FF, false);
+  // released after fn, still the fkey
+  mock_key(KC_1, false);
+  EXPECT_FALSE(mock_is_pressed(KC_F1));
+
+  mock_clear_log();
+  mock_tap(KC_EQL);
+  EXPECT_EVENT(0, MOCK_REGISTER, KC_EQL);
+  EXPECT_EVENT(1, MOCK_UNREGISTER, KC_EQL);
+}
+
+static void apple_ff_f4_is_spotlight_on_mac(void) {
+  mock_key(APPLE_FF, true);
+  mock_key(KC_4, true);
+  EXPECT_TRUE(host_apple_is_pressed(1 << USAGE_INDEX_AVK_SPOTLIGHT));
+  EXPECT_FALSE(mock_is_pressed(KC_F4));
+  mock_key(KC_4, false);
+  mock_key(APPLE_FF, false);
+  EXPECT_FALSE(host_apple_is_pressed(1 << USAGE_INDEX_AVK_SPOTLIGHT));
+}
+
+static void non_mac_fn_overrides_fkeys(void) {
+  non_mac_mode();
+  mock_key(APPLE_FN, true);
+  mock_key(KC_F1, true);
+  EXPECT_TRUE(mock_is_pressed(KC_BRID));
+  EXPECT_FALSE(mock_is_pressed(KC_F1));
+  mock_key(APPLE_FN, false);
+  mock_key(KC_F1, false);
+  EXPECT_FALSE(mock_is_pressed(KC_BRID));
+
+  // without fn
+  mock_key(KC_F1, true);
+  EXPECT_TRUE(mock_is_pressed(KC_F1));
+  mock_key(KC_F1, false);
+}
+
+static void non_mac_fn_overrides_cursor_keys(void) {
+  non_mac_mode();
+  mock_key(APPLE_FN, true);
+  mock_tap(KC_BSPC);
+  mock_tap(KC_UP);
+  mock_key(APPLE_FN, false);
+  EXPECT_TRUE(mock_find(0, MOCK_REGISTER, KC_DEL) >= 0);
+  EXPECT_TRUE(mock_find(0, MOCK_REGISTER, KC_PGUP) >= 0);
+  EXPECT_EQ(mock_find(0, MOCK_REGISTER, KC_BSPC), -1);
+}
+
+static void non_mac_fn_respects_group_switches(void) {
+  non_mac_mode();
+  custom_config_non_mac_fn_set_fkey(false);
+  mock_key(APPLE_FN, true);
+  mock_tap(KC_F1);
+  mock_tap(KC_BSPC);
+  mock_key(APPLE_FN, false);
+  EXPECT_TRUE(mock_find(0, MOCK_REGISTER, KC_F1) >= 0);
+  EXPECT_TRUE(mock_find(0, MOCK_REGISTER, KC_DEL) >= 0);
+}
+
+static void non_mac_fn_keycode_is_dynamic(void) {
+  non_mac_mode();
+  eeprom_update_word((uint16_t *)DYNAMIC_NON_MAC_FN_EEPROM_ADDR + FN_F1, KC_MUTE);
+  mock_key(APPLE_FN, true);
+  mock_tap(KC_F1);
+  mock_key(APPLE_FN, false);
+  EXPECT_TRUE(mock_find(0, MOCK_REGISTER, KC_MUTE) >= 0);
+}
+
+int main(void) {
+  RUN_TEST(apple_fn_sends_fn_usage);
+  RUN_TEST(apple_ff_maps_number_row_to_fkeys);
+  RUN_TEST(apple_ff_f4_is_spotlight_on_mac);
+  RUN_TEST(non_mac_fn_overrides_fkeys);
+  RUN_TEST(non_mac_fn_overrides_cursor_keys);
+  RUN_TEST(non_mac_fn_respects_group_switches);
+  RUN_TEST(non_mac_fn_keycode_is_dynamic);
+  return TEST_RESULT();
+}
@@ -0,0 +1,24 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+// keyboard + keymap config.h of a host "keyboard", force included like QMK does
+
+#define TAPPING_TERM 200
+#define NUM_TAP_DANCE_PREDEFINED_ENTRIES 2
+#define VIA_EEPROM_CUSTOM_CONFIG_ADDR 64
+
+#include "../config.h"
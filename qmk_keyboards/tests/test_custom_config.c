@@ -0,0 +1,132 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "custom_config.h"
+#include "custom_keycodes.h"
+#include "test.h"
+
+static void defaults_after_reset(void) {
+  EXPECT_FALSE(custom_config_raw_hid_is_enable());
+  EXPECT_TRUE(custom_config_mac_is_enable());
+  EXPECT_TRUE(custom_config_auto_detect_is_enable());
+  EXPECT_FALSE(custom_config_usj_is_enable());
+  EXPECT_EQ(custom_config_rc_get_encoder_clicks(), 36);
+  EXPECT_EQ(custom_config_rc_get_key_angular_speed(), 90);
+  EXPECT_EQ(eeconfig_read_kb(), kb_config.raw);
+}
+
+static void keycodes_update_eeconfig(void) {
+  mock_tap(RHID_ON);
+  EXPECT_TRUE(custom_config_raw_hid_is_enable());
+  mock_tap(USJ_ON);
+  EXPECT_TRUE(custom_config_usj_is_enable());
+  EXPECT_EQ(eeconfig_read_kb(), kb_config.raw);
+
+  // restored from eeconfig
+  kb_config.raw = 0;
+  custom_config_init();
+  EXPECT_TRUE(custom_config_raw_hid_is_enable());
+  EXPECT_TRUE(custom_config_usj_is_enable());
+  // consumed, not sent to the host
+  EXPECT_EQ(mock_find(0, MOCK_REGISTER, RHID_ON & 0xff), -1);
+}
+
+static void shift_reverses_keycodes(void) {
+  mock_key(KC_LSFT, true);
+  mock_tap(RHID_OFF);
+  EXPECT_TRUE(custom_config_raw_hid_is_enable());
+  mock_tap(RHID_ON);
+  EXPECT_FALSE(custom_config_raw_hid_is_enable());
+  mock_key(KC_LSFT, false);
+}
+
+static void mac_off_switches_base_layer_and_reconnects(void) {
+  mock_tap(MAC_OFF);
+  EXPECT_FALSE(custom_config_mac_is_enable());
+  int layer = mock_find(0, MOCK_LAYER, 1 << NON_MAC_BASE_LAYER);
+  EXPECT_TRUE(layer >= 0);
+  // the alternate product id needs a re-enumeration
+  EXPECT_TRUE(mock_find(layer, MOCK_SOFT_RESET, 0) > layer);
+
+  // no change, no reconnect
+  mock_clear_log();
+  mock_tap(MAC_OFF);
+  EXPECT_EQ(mock_find(0, MOCK_SOFT_RESET, 0), -1);
+}
+
+static void mac_without_reset_does_not_reconnect(void) {
+  custom_config_mac_set_enable_without_reset(false);
+  EXPECT_TRUE(mock_find(0, MOCK_LAYER, 1 << NON_MAC_BASE_LAYER) >= 0);
+  EXPECT_EQ(mock_find(0, MOCK_SOFT_RESET, 0), -1);
+}
+
+static void auto_detect_on_reconnects(void) {
+  mock_tap(AUT_OFF);
+  EXPECT_FALSE(custom_config_auto_detect_is_enable());
+  EXPECT_EQ(mock_find(0, MOCK_SOFT_RESET, 0), -1);
+  mock_tap(AUT_ON);
+  EXPECT_TRUE(custom_config_auto_detect_is_enable());
+  EXPECT_TRUE(mock_find(0, MOCK_SOFT_RESET, 0) >= 0);
+}
+
+static void fine_tune_mods_match_all(void) {
+  // default: fn only
+  EXPECT_FALSE(custom_config_rc_is_fine_tune_mods_now());
+  host_apple_send(true, USAGE_INDEX_AVT_KEYBOARD_FN);
+  EXPECT_TRUE(custom_config_rc_is_fine_tune_mods_now());
+  host_apple_send(false, USAGE_INDEX_AVT_KEYBOARD_FN);
+
+  // ctrl + shift
+  rc_config.fine_tune_mods = 0x03;
+  add_mods(MOD_BIT(KC_LCTL));
+  EXPECT_FALSE(custom_config_rc_is_fine_tune_mods_now());
+  add_mods(MOD_BIT(KC_RSFT));
+  EXPECT_TRUE(custom_config_rc_is_fine_tune_mods_now());
+
+  // disabled by ratio
+  rc_config.fine_tune_ratio = 0;
+  EXPECT_FALSE(custom_config_rc_is_fine_tune_mods_now());
+}
+
+static void tap_dance_entries_in_eeprom(void) {
+  EXPECT_EQ(dynamic_tap_dance_keycode(0, TD_SINGLE_TAP), KC_LNG2);
+  EXPECT_EQ(dynamic_tap_dance_keycode(0, TD_SINGLE_HOLD), APPLE_FF);
+  EXPECT_EQ(dynamic_tap_dance_keycode(0, TD_MULTI_TAP), KC_LNG1);
+  EXPECT_EQ(dynamic_tap_dance_keycode(0, TD_TAP_HOLD), APPLE_FF);
+  EXPECT_EQ(dynamic_tap_dance_keycode(1, TD_TAP_HOLD), MO(3));
+  EXPECT_EQ(dynamic_tap_dance_tapping_term(0), TAPPING_TERM);
+  // not predefined
+  EXPECT_EQ(dynamic_tap_dance_keycode(2, TD_SINGLE_TAP), KC_NO);
+  EXPECT_EQ(dynamic_tap_dance_tapping_term(2), TAPPING_TERM);
+  // out of range
+  EXPECT_EQ(dynamic_tap_dance_keycode(TAP_DANCE_ENTRIES, TD_SINGLE_TAP), KC_NO);
+  EXPECT_EQ(dynamic_tap_dance_tapping_term(TAP_DANCE_ENTRIES), TAPPING_TERM);
+
+  // reserved bits of the tapping term are masked
+  eeprom_update_word((uint16_t *)(DYNAMIC_TAP_DANCE_EEPROM_ADDR + 8 + 10 * 3), 0xfc00 | 300);
+  EXPECT_EQ(dynamic_tap_dance_tapping_term(3), 300);
+}
+
+int main(void) {
+  RUN_TEST(defaults_after_reset);
+  RUN_TEST(keycodes_update_eeconfig);
+  RUN_TEST(shift_reverses_keycodes);
+  RUN_TEST(mac_off_switches_base_layer_and_reconnects);
+  RUN_TEST(mac_without_reset_does_not_reconnect);
+  RUN_TEST(auto_detect_on_reconnects);
+  RUN_TEST(fine_tune_mods_match_all);
+  RUN_TEST(tap_dance_entries_in_eeprom);
+  return TEST_RESULT();
+}
@@ -0,0 +1,79 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <keymap_extras/keymap_japanese.h>
+
+#include "my_keyboard_common.h"
+#include "test.h"
+
+static void eisu_kana_toggles(void) {
+  mock_tap(EISU_KANA);
+  mock_tap(EISU_KANA);
+  EXPECT_EQ(mock_log_count(), 4);
+  EXPECT_EVENT(0, MOCK_REGISTER, KC_LNG1);
+  EXPECT_EVENT(1, MOCK_UNREGISTER, KC_LNG1);
+  EXPECT_EVENT(2, MOCK_REGISTER, KC_LNG2);
+  EXPECT_EVENT(3, MOCK_UNREGISTER, KC_LNG2);
+}
+
+static void usj_off_passes_through(void) {
+  mock_tap(KC_QUOT);
+  EXPECT_EVENT(0, MOCK_REGISTER, KC_QUOT);
+  EXPECT_EVENT(1, MOCK_UNREGISTER, KC_QUOT);
+}
+
+static void usj_converts_unshifted(void) {
+  custom_config_usj_set_enable(true);
+  // ' is shift+7 on JIS
+  mock_key(KC_QUOT, true);
+  EXPECT_TRUE(mock_is_pressed(KC_7));
+  // shift of the converted key does not stick as a weak mod
+  EXPECT_EQ(get_weak_mods(), 0);
+  mock_key(KC_QUOT, false);
+  EXPECT_FALSE(mock_is_pressed(KC_7));
+  EXPECT_FALSE(mock_is_pressed(KC_QUOT));
+}
+
+static void usj_converts_shifted(void) {
+  custom_config_usj_set_enable(true);
+  // @ is a plain key on JIS, shift is released while it is sent
+  mock_key(KC_LSFT, true);
+  mock_key(KC_2, true);
+  EXPECT_TRUE(mock_is_pressed(JP_AT));
+  EXPECT_FALSE(mock_is_pressed(KC_2));
+  EXPECT_TRUE(get_mods() & MOD_MASK_SHIFT);
+  // shift released first, release follows the press
+  mock_key(KC_LSFT, false);
+  mock_key(KC_2, false);
+  EXPECT_FALSE(mock_is_pressed(JP_AT));
+  EXPECT_FALSE(mock_is_pressed(KC_2));
+}
+
+static void usj_unmapped_shifted_passes_through(void) {
+  custom_config_usj_set_enable(true);
+  // 2 has no unshifted conversion
+  mock_tap(KC_2);
+  EXPECT_EVENT(0, MOCK_REGISTER, KC_2);
+  EXPECT_EVENT(1, MOCK_UNREGISTER, KC_2);
+}
+
+int main(void) {
+  RUN_TEST(eisu_kana_toggles);
+  RUN_TEST(usj_off_passes_through);
+  RUN_TEST(usj_converts_unshifted);
+  RUN_TEST(usj_converts_shifted);
+  RUN_TEST(usj_unmapped_shifted_passes_through);
+  return TEST_RESULT();
+}
@@ -0,0 +1,163 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "custom_config.h"
+#include "os_fingerprint.h"
+#include "test.h"
+
+/*
+ * GET_DESCRIPTOR sequences replayed from resources/os_detection_data.js, 1ms apart.
+ * the detected os is observed through os_fingerprint_update_kb() of my_keyboard_common.c,
+ * which switches mac mode (default layer) when auto detection is enabled.
+ */
+
+void trace_usb_get_descriptor(const uint8_t dtype, const uint16_t w_length);
+
+static const uint8_t macos_intel_13_1[][2] = {
+  {0x01, 0x08}, {0x01, 0x12}, {0x03, 0x02}, {0x03, 0x14}, {0x03, 0x02},
+  {0x03, 0x0a}, {0x02, 0x09}, {0x02, 0x5b}, {0x22, 0x40}, {0x22, 0x22},
+  {0x22, 0x87}, {0x03, 0x02}, {0x03, 0x04}, {0x03, 0xff},
+};
+
+static const uint8_t ipad_os_16_2[][2] = {
+  {0x01, 0x08}, {0x01, 0x12}, {0x03, 0x02}, {0x03, 0x14}, {0x03, 0x02}, {0x03, 0x0a},
+  {0x02, 0x09}, {0x02, 0x5b}, {0x22, 0x22}, {0x22, 0x87}, {0x22, 0x40},
+};
+
+static const uint8_t windows_11_pro_22H2[][2] = {
+  {0x01, 0x40}, {0x01, 0x12}, {0x02, 0xff}, {0x03, 0xff}, {0x03, 0xff}, {0x06, 0x0a},
+  {0x01, 0x12}, {0x02, 0x09}, {0x02, 0x5b}, {0x03, 0x04}, {0x03, 0x14}, {0x03, 0xff},
+  {0x03, 0x04}, {0x03, 0xff}, {0x03, 0x14}, {0x03, 0xff}, {0x03, 0xff}, {0x03, 0xff},
+  {0x03, 0x04}, {0x03, 0xff}, {0x03, 0x14}, {0x22, 0x80}, {0x22, 0x62}, {0x22, 0xc7},
+  {0x02, 0x09}, {0x02, 0x5b},
+};
+
+static const uint8_t android_13[][2] = {
+  {0x01, 0x40}, {0x01, 0x12}, {0x06, 0x0a}, {0x06, 0x0a}, {0x06, 0x0a}, {0x02, 0x09},
+  {0x02, 0x5b}, {0x03, 0xff}, {0x03, 0xff}, {0x03, 0xff}, {0x22, 0x40}, {0x22, 0x22},
+  {0x22, 0x87}, {0x03, 0xfe}, {0x03, 0xff}, {0x03, 0xfe}, {0x03, 0xff}, {0x03, 0xfe},
+  {0x03, 0xff}, {0x03, 0xfe}, {0x03, 0xff},
+};
+
+static const uint8_t unknown_host[][2] = {
+  {0x01, 0x12}, {0x02, 0x09}, {0x02, 0x5b}, {0x03, 0xff},
+};
+
+#define REPLAY(requests) replay(requests, sizeof(requests) / sizeof(requests[0]))
+
+static void replay(const uint8_t (*requests)[2], uint8_t len) {
+  for (uint8_t i = 0; i < len; i++) {
+    trace_usb_get_descriptor(requests[i][0], requests[i][1]);
+    mock_advance(1);
+  }
+}
+
+static void non_mac_mode(void) {
+  custom_config_mac_set_enable(false);
+  mock_clear_log();
+}
+
+// the os is notified settle ms after the last request
+static void expect_mac_after(uint32_t settle, bool mac) {
+  mock_advance(settle - 2);
+  EXPECT_EQ(mock_log_count(), 0);
+  mock_advance(1);
+  EXPECT_TRUE(mock_find(0, MOCK_LAYER, 1 << (mac ? MAC_BASE_LAYER : NON_MAC_BASE_LAYER)) >= 0);
+  EXPECT_EQ(custom_config_mac_is_enable(), mac);
+}
+
+static void macos_is_darwin(void) {
+  non_mac_mode();
+  REPLAY(macos_intel_13_1);
+  expect_mac_after(200, true);
+}
+
+static void ipados_is_darwin(void) {
+  non_mac_mode();
+  // the signature is a prefix of macos, darwin either way
+  REPLAY(ipad_os_16_2);
+  expect_mac_after(200, true);
+}
+
+static void darwin_prefix_is_darwin(void) {
+  non_mac_mode();
+  // enumeration stopped within the prefix shared by macOS and iOS
+  replay(macos_intel_13_1, 3);
+  expect_mac_after(200, true);
+}
+
+static void windows_is_not_darwin(void) {
+  REPLAY(windows_11_pro_22H2);
+  expect_mac_after(200, false);
+}
+
+static void android_is_not_darwin(void) {
+  REPLAY(android_13);
+  expect_mac_after(200, false);
+}
+
+static void unknown_host_times_out(void) {
+  REPLAY(unknown_host);
+  expect_mac_after(1000, false);
+}
+
+static void hid_reports_are_folded(void) {
+  non_mac_mode();
+  // one HID report request per interface, any number of interfaces
+  for (uint8_t i = 0; i < 8; i++) {
+    trace_usb_get_descriptor(macos_intel_13_1[i][0], macos_intel_13_1[i][1]);
+  }
+  for (uint8_t i = 0; i < 5; i++) {
+    trace_usb_get_descriptor(0x22, 0x40 + i);
+  }
+  trace_usb_get_descriptor(0x03, 0x02);
+  mock_advance(201);
+  EXPECT_TRUE(custom_config_mac_is_enable());
+}
+
+static void auto_detect_disabled(void) {
+  custom_config_auto_detect_set_enable(false);
+  mock_clear_log();
+  REPLAY(windows_11_pro_22H2);
+  mock_advance(1000);
+  EXPECT_EQ(mock_log_count(), 0);
+  EXPECT_TRUE(custom_config_mac_is_enable());
+}
+
+static void re_enumeration_detects_again(void) {
+  REPLAY(windows_11_pro_22H2);
+  mock_advance(200);
+  EXPECT_FALSE(custom_config_mac_is_enable());
+  // requests after sleep don't start a new detection
+  trace_usb_get_descriptor(0x03, 0xff);
+  mock_advance(1000);
+  EXPECT_FALSE(custom_config_mac_is_enable());
+  mock_clear_log();
+  REPLAY(macos_intel_13_1);
+  expect_mac_after(200, true);
+}
+
+int main(void) {
+  RUN_TEST(macos_is_darwin);
+  RUN_TEST(ipados_is_darwin);
+  RUN_TEST(darwin_prefix_is_darwin);
+  RUN_TEST(windows_is_not_darwin);
+  RUN_TEST(android_is_not_darwin);
+  RUN_TEST(unknown_host_times_out);
+  RUN_TEST(hid_reports_are_folded);
+  RUN_TEST(auto_detect_disabled);
+  RUN_TEST(re_enumeration_detects_again);
+  return TEST_RESULT();
+}
@@ -0,0 +1,156 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "custom_config.h"
+#include "custom_keycodes.h"
+#include "radial_controller.h"
+#include "test.h"
+
+/*
+ * defaults: 36 encoder clicks per rotation (100 = 10 degree per click), keys rotate 90 degree
+ * per second, fine tune 1/4, no acceleration.
+ */
+
+#define INTERVAL RADIAL_CONTROLLER_REPORT_INTERVAL_MILLIS
+
+// sum of dial reports from i
+static int32_t dial_sum(uint16_t i) {
+  int32_t sum = 0;
+  for (; i < mock_log_count(); i++) {
+    if (mock_log(i)->type == MOCK_RADIAL) {
+      sum += mock_log(i)->value;
+    }
+  }
+  return sum;
+}
+
+static void button(void) {
+  mock_key(RC_BTN, true);
+  mock_key(RC_BTN, false);
+  EXPECT_EQ(mock_log_count(), 2);
+  EXPECT_EVENT(0, MOCK_RADIAL, 1);
+  EXPECT_EVENT(1, MOCK_RADIAL, 0);
+  EXPECT_EQ(mock_log(0)->value, 0);
+}
+
+static void encoder_click_reports_immediately(void) {
+  mock_encoder(RC_CW, true);
+  EXPECT_EQ(mock_log_count(), 1);
+  EXPECT_EQ(mock_log(0)->value, 100);
+  mock_encoder(RC_CCW, false);
+  // in the same interval, coalesced
+  EXPECT_EQ(mock_log_count(), 1);
+  mock_advance(INTERVAL);
+  EXPECT_EQ(mock_log_count(), 2);
+  EXPECT_EQ(mock_log(1)->value, -100);
+  // nothing left, service stops
+  mock_advance(INTERVAL * 5);
+  EXPECT_EQ(mock_log_count(), 2);
+}
+
+static void encoder_burst_is_coalesced(void) {
+  for (uint8_t i = 0; i < 5; i++) {
+    mock_encoder(RC_CW, true);
+  }
+  mock_advance(INTERVAL);
+  EXPECT_EQ(mock_log_count(), 2);
+  EXPECT_EQ(mock_log(1)->value, 400);
+}
+
+static void report_is_clamped_to_one_rotation(void) {
+  for (uint8_t i = 0; i < 50; i++) {
+    mock_encoder(RC_CW, true);
+  }
+  mock_advance(INTERVAL * 3);
+  EXPECT_EQ(mock_log_count(), 3);
+  EXPECT_EQ(mock_log(1)->value, 3600);
+  // remainder goes with the next report
+  EXPECT_EQ(mock_log(2)->value, 1300);
+}
+
+static void encoder_fine_tune(void) {
+  mock_key(RC_FINE, true);
+  mock_encoder(RC_CW, true);
+  mock_key(RC_FINE, false);
+  EXPECT_EQ(mock_log(0)->value, 100 >> 2);
+}
+
+static void encoder_acceleration(void) {
+  rc_config.acceleration = 3;
+  mock_advance(1000);
+  mock_encoder(RC_CW, true);
+  EXPECT_EQ(mock_log(0)->value, 100);
+  mock_advance(50);
+  mock_encoder(RC_CW, true);
+  mock_advance(INTERVAL);
+  // 100 * (1 + 3 * 50 / 100)
+  EXPECT_EQ(dial_sum(1), 250);
+}
+
+static void key_rotates_at_angular_speed(void) {
+  mock_key(RC_CW, true);
+  // first interval is reported at once
+  EXPECT_EQ(mock_log_count(), 1);
+  EXPECT_EQ(mock_log(0)->value, 9);
+  mock_advance(1000);
+  mock_key(RC_CW, false);
+  mock_advance(INTERVAL * 5);
+  // 90 degree per second in 1/10 degree
+  EXPECT_EQ(mock_log_count(), 101);
+  EXPECT_EQ(dial_sum(0), 909);
+}
+
+static void key_fine_tune_keeps_fraction(void) {
+  mock_key(RC_FINE, true);
+  mock_key(RC_CCW, true);
+  mock_advance(1000);
+  mock_key(RC_CCW, false);
+  mock_key(RC_FINE, false);
+  mock_advance(INTERVAL * 5);
+  // 22 degree per second, 2.2 per interval
+  EXPECT_EQ(dial_sum(0), -(101 * 22 / 10));
+}
+
+static void opposite_keys_stop_rotation(void) {
+  mock_key(RC_CW, true);
+  mock_advance(INTERVAL * 2);
+  mock_key(RC_CCW, true);
+  int32_t before = dial_sum(0);
+  // the last pressed key wins
+  mock_advance(INTERVAL * 2);
+  EXPECT_TRUE(dial_sum(0) < before);
+  mock_key(RC_CCW, false);
+  // back to the key still held
+  uint16_t i = mock_log_count();
+  mock_advance(INTERVAL * 2);
+  EXPECT_TRUE(dial_sum(i) > 0);
+  mock_key(RC_CW, false);
+  i = mock_log_count();
+  mock_advance(INTERVAL * 5);
+  EXPECT_EQ(dial_sum(i), 0);
+}
+
+int main(void) {
+  RUN_TEST(button);
+  RUN_TEST(encoder_click_reports_immediately);
+  RUN_TEST(encoder_burst_is_coalesced);
+  RUN_TEST(report_is_clamped_to_one_rotation);
+  RUN_TEST(encoder_fine_tune);
+  RUN_TEST(encoder_acceleration);
+  RUN_TEST(key_rotates_at_angular_speed);
+  RUN_TEST(key_fine_tune_keeps_fraction);
+  RUN_TEST(opposite_keys_stop_rotation);
+  return TEST_RESULT();
+}
@@ -0,0 +1,148 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "custom_config.h"
+#include "custom_keycodes.h"
+#include "tap_dance.h"
+#include "test.h"
+
+/*
+ * TD(0): tap KC_LNG2, hold APPLE_FF, multi tap KC_LNG1, tap hold APPLE_FF (test_keymap.c)
+ */
+
+static void set_entry(uint8_t index, tap_dance_entry_t entry) {
+  eeprom_update_block(&entry, (void *)(DYNAMIC_TAP_DANCE_EEPROM_ADDR + 10 * index),
+                      sizeof(entry));
+  tap_dance_update_outcomes(index);
+}
+
+static void single_tap_after_tapping_term(void) {
+  mock_tap(TD(0));
+  EXPECT_EQ(mock_log_count(), 0);
+  mock_advance(TAPPING_TERM);
+  EXPECT_EQ(mock_log_count(), 0);
+  mock_advance(1);
+  EXPECT_EQ(mock_log_count(), 2);
+  EXPECT_EVENT(0, MOCK_REGISTER, KC_LNG2);
+  EXPECT_EVENT(1, MOCK_UNREGISTER, KC_LNG2);
+}
+
+static void single_hold_until_release(void) {
+  mock_key(TD(0), true);
+  mock_advance(TAPPING_TERM + 1);
+  EXPECT_EQ(mock_log_count(), 1);
+  EXPECT_EVENT(0, MOCK_APPLE, USAGE_INDEX_AVT_KEYBOARD_FN);
+  EXPECT_EQ(mock_log(0)->value, true);
+  mock_key(TD(0), false);
+  EXPECT_EQ(mock_log_count(), 2);
+  EXPECT_EVENT(1, MOCK_APPLE, USAGE_INDEX_AVT_KEYBOARD_FN);
+  EXPECT_EQ(mock_log(1)->value, false);
+}
+
+static void multi_tap(void) {
+  mock_tap(TD(0));
+  mock_advance(50);
+  mock_tap(TD(0));
+  mock_advance(TAPPING_TERM + 1);
+  EXPECT_EQ(mock_log_count(), 2);
+  EXPECT_EVENT(0, MOCK_REGISTER, KC_LNG1);
+  EXPECT_EVENT(1, MOCK_UNREGISTER, KC_LNG1);
+}
+
+static void interrupted_hold_with_keycode(void) {
+  mock_key(TD(0), true);
+  mock_advance(50);
+  mock_key(KC_A, true);
+  // resolved before the interrupting key
+  EXPECT_EVENT(0, MOCK_APPLE, USAGE_INDEX_AVT_KEYBOARD_FN);
+  EXPECT_EVENT(1, MOCK_REGISTER, KC_A);
+  mock_key(KC_A, false);
+  mock_key(TD(0), false);
+}
+
+static void interrupted_hold_without_keycode_is_tap(void) {
+  set_entry(2, (tap_dance_entry_t){.on_single_tap = KC_B, .on_multi_tap = KC_C,
+                                   .tapping_term = TAPPING_TERM});
+  mock_key(TD(2), true);
+  mock_advance(50);
+  mock_key(KC_A, true);
+  EXPECT_EVENT(0, MOCK_REGISTER, KC_B);
+  EXPECT_EVENT(1, MOCK_REGISTER, KC_A);
+  mock_key(KC_A, false);
+  mock_key(TD(2), false);
+  EXPECT_FALSE(mock_is_pressed(KC_B));
+}
+
+static void finishes_early_without_other_outcomes(void) {
+  set_entry(2, (tap_dance_entry_t){.on_single_tap = KC_B, .tapping_term = TAPPING_TERM});
+  mock_key(TD(2), true);
+  EXPECT_EQ(mock_log_count(), 0);
+  // nothing else is reachable, no wait for the tapping term
+  mock_key(TD(2), false);
+  EXPECT_EQ(mock_log_count(), 2);
+  EXPECT_EVENT(0, MOCK_REGISTER, KC_B);
+  EXPECT_EVENT(1, MOCK_UNREGISTER, KC_B);
+  // and a new dance starts with the next press
+  mock_tap(TD(2));
+  EXPECT_EQ(mock_log_count(), 4);
+}
+
+static void hold_only_finishes_on_press(void) {
+  set_entry(2, (tap_dance_entry_t){.on_single_hold = KC_LCTL, .tapping_term = TAPPING_TERM});
+  mock_key(TD(2), true);
+  EXPECT_TRUE(get_mods() & MOD_BIT(KC_LCTL));
+  mock_key(TD(2), false);
+  EXPECT_FALSE(get_mods() & MOD_BIT(KC_LCTL));
+}
+
+static void per_entry_tapping_term(void) {
+  set_entry(2, (tap_dance_entry_t){.on_single_tap = KC_B, .on_single_hold = KC_C,
+                                   .tapping_term = 300});
+  mock_key(TD(2), true);
+  mock_advance(TAPPING_TERM + 1);
+  EXPECT_EQ(mock_log_count(), 0);
+  mock_advance(300 - TAPPING_TERM);
+  EXPECT_EVENT(0, MOCK_REGISTER, KC_C);
+  mock_key(TD(2), false);
+}
+
+static void captured_mods_apply_to_keycode(void) {
+  mock_key(KC_LSFT, true);
+  mock_key(TD(0), true);
+  mock_key(KC_LSFT, false);
+  mock_key(TD(0), false);
+  mock_clear_log();
+  mock_advance(TAPPING_TERM + 1);
+  int i = mock_find(0, MOCK_REGISTER, KC_LNG2);
+  EXPECT_TRUE(i >= 0);
+  if (i >= 0) {
+    EXPECT_EQ(mock_log(i)->value, MOD_BIT(KC_LSFT));
+  }
+  // cleared on reset
+  EXPECT_EQ(get_weak_mods(), 0);
+}
+
+int main(void) {
+  RUN_TEST(single_tap_after_tapping_term);
+  RUN_TEST(single_hold_until_release);
+  RUN_TEST(multi_tap);
+  RUN_TEST(interrupted_hold_with_keycode);
+  RUN_TEST(interrupted_hold_without_keycode_is_tap);
+  RUN_TEST(finishes_early_without_other_outcomes);
+  RUN_TEST(hold_only_finishes_on_press);
+  RUN_TEST(per_entry_tapping_term);
+  RUN_TEST(captured_mods_apply_to_keycode);
+  return TEST_RESULT();
+}
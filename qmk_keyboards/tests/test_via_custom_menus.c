@@ -0,0 +1,147 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "custom_config.h"
+#include "custom_keycodes.h"
+#include "test.h"
+#include "via_custom_menus.h"
+
+#define RAW_EPSIZE 32
+
+// VIA raw hid packet: [command_id, channel_id, value_id, value_data...], returns data
+static uint8_t *via_command(uint8_t command_id, uint8_t channel_id, uint8_t value_id,
+                            uint8_t data0, uint8_t data1) {
+  static uint8_t packet[RAW_EPSIZE];
+  memset(packet, 0, sizeof(packet));
+  packet[0] = command_id;
+  packet[1] = channel_id;
+  packet[2] = value_id;
+  packet[3] = data0;
+  packet[4] = data1;
+  via_raw_hid_receive(packet, sizeof(packet));
+  return packet;
+}
+
+static uint16_t get_word(uint8_t channel_id, uint8_t value_id) {
+  uint8_t *packet = via_command(id_custom_get_value, channel_id, value_id, 0, 0);
+  return (uint16_t)packet[3] << 8 | packet[4];
+}
+
+static void set_word(uint8_t channel_id, uint8_t value_id, uint16_t value) {
+  via_command(id_custom_set_value, channel_id, value_id, value >> 8, value & 0xff);
+}
+
+static void magic_toggles_eeconfig(void) {
+  via_command(id_custom_set_value, id_custom_magic_channel, id_custom_magic_swap_lalt_lgui, 1, 0);
+  keymap_config_t config = {.raw = eeconfig_read_keymap()};
+  EXPECT_TRUE(config.swap_lalt_lgui);
+  EXPECT_FALSE(config.swap_control_capslock);
+  uint8_t *packet =
+    via_command(id_custom_get_value, id_custom_magic_channel, id_custom_magic_swap_lalt_lgui, 0, 0);
+  EXPECT_EQ(packet[3], 1);
+}
+
+static void rc_values_are_saved_deferred(void) {
+  via_command(id_custom_set_value, id_custom_rc_channel, id_custom_rc_encoder_clicks, 24, 0);
+  via_command(id_custom_set_value, id_custom_rc_channel, id_custom_rc_fine_tune_mod_shift, 1, 0);
+  EXPECT_EQ(custom_config_rc_get_encoder_clicks(), 24);
+  EXPECT_EQ(custom_config_rc_is_fine_tune_mods(), 0x12);
+  uint8_t *packet =
+    via_command(id_custom_get_value, id_custom_rc_channel, id_custom_rc_fine_tune_mod_shift, 0, 0);
+  EXPECT_EQ(packet[3], 1);
+
+  // written once the GUI settles
+  EXPECT_EQ(mock_eeprom_byte(RADIAL_CONTROLLER_EEPROM_ADDR), 36);
+  mock_advance(399);
+  EXPECT_EQ(mock_eeprom_byte(RADIAL_CONTROLLER_EEPROM_ADDR), 36);
+  mock_advance(1);
+  EXPECT_EQ(mock_eeprom_byte(RADIAL_CONTROLLER_EEPROM_ADDR), 24);
+}
+
+static void rc_deferred_write_is_extended(void) {
+  via_command(id_custom_set_value, id_custom_rc_channel, id_custom_rc_encoder_clicks, 24, 0);
+  mock_advance(300);
+  via_command(id_custom_set_value, id_custom_rc_channel, id_custom_rc_encoder_clicks, 72, 0);
+  mock_advance(300);
+  EXPECT_EQ(mock_eeprom_byte(RADIAL_CONTROLLER_EEPROM_ADDR), 36);
+  mock_advance(100);
+  EXPECT_EQ(mock_eeprom_byte(RADIAL_CONTROLLER_EEPROM_ADDR), 72);
+}
+
+static void td_keycodes_are_big_endian(void) {
+  uint8_t td1 = id_custom_td_channel_start + 1;
+  EXPECT_EQ(get_word(id_custom_td_channel_start, id_custom_td_single_hold), APPLE_FF);
+  EXPECT_EQ(get_word(td1, id_custom_td_tap_hold), MO(3));
+  EXPECT_EQ(get_word(td1, id_custom_td_tapping_term), TAPPING_TERM);
+
+  set_word(td1, id_custom_td_single_tap, S(KC_A));
+  EXPECT_EQ(get_word(td1, id_custom_td_single_tap), S(KC_A));
+  EXPECT_EQ(dynamic_tap_dance_keycode(1, TD_SINGLE_TAP), S(KC_A));
+}
+
+static void td_keycode_updates_outcomes(void) {
+  uint8_t td2 = id_custom_td_channel_start + 2;
+  set_word(td2, id_custom_td_single_tap, KC_B);
+  set_word(td2, id_custom_td_multi_tap, KC_C);
+  // a second tap is possible, the tap waits for the tapping term
+  mock_tap(TD(2));
+  EXPECT_EQ(mock_log_count(), 0);
+  mock_advance(TAPPING_TERM + 1);
+  EXPECT_EVENT(0, MOCK_REGISTER, KC_B);
+
+  set_word(td2, id_custom_td_multi_tap, KC_NO);
+  mock_clear_log();
+  // nothing else is reachable, finished on release
+  mock_tap(TD(2));
+  EXPECT_EVENT(0, MOCK_REGISTER, KC_B);
+}
+
+static void td_tapping_term_is_saved_deferred(void) {
+  uint8_t td3 = id_custom_td_channel_start + 3;
+  set_word(td3, id_custom_td_tapping_term, 350);
+  mock_advance(400);
+  EXPECT_EQ(get_word(td3, id_custom_td_tapping_term), 350);
+  EXPECT_EQ(dynamic_tap_dance_tapping_term(3), 350);
+}
+
+static void non_mac_fn_keycodes(void) {
+  set_word(id_custom_non_mac_fn_channel, id_custom_non_mac_fn_f5, KC_MPLY);
+  EXPECT_EQ(get_word(id_custom_non_mac_fn_channel, id_custom_non_mac_fn_f5), KC_MPLY);
+  EXPECT_EQ(dynamic_non_mac_fn_keycode(FN_F5), KC_MPLY);
+
+  via_command(id_custom_set_value, id_custom_non_mac_fn_channel, id_custom_non_mac_fn_cursor, 0,
+              0);
+  EXPECT_FALSE(custom_config_non_mac_fn_cursor_is_enable());
+  EXPECT_EQ(eeconfig_read_kb(), kb_config.raw);
+}
+
+static void unknown_channel_is_unhandled(void) {
+  uint8_t *packet = via_command(id_custom_get_value, id_custom_channel_user_range, 1, 0, 0);
+  EXPECT_EQ(packet[0], id_unhandled);
+  packet = via_command(id_custom_get_value, id_custom_td_channel_start, 1, 0, 0);
+  EXPECT_EQ(packet[0], id_custom_get_value);
+}
+
+int main(void) {
+  RUN_TEST(magic_toggles_eeconfig);
+  RUN_TEST(rc_values_are_saved_deferred);
+  RUN_TEST(rc_deferred_write_is_extended);
+  RUN_TEST(td_keycodes_are_big_endian);
+  RUN_TEST(td_keycode_updates_outcomes);
+  RUN_TEST(td_tapping_term_is_saved_deferred);
+  RUN_TEST(non_mac_fn_keycodes);
+  RUN_TEST(unknown_channel_is_unhandled);
+  return TEST_RESULT();
+}
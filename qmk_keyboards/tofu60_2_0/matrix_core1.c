@@ -0,0 +1,156 @@
+/* Copyright 2024 masafumi
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Matrix scan and debounce on core1, keymap processing and USB on core0.
+// core1 runs without ChibiOS, code and data it touches are in RAM so that flash writes
+// (wear-leveling EEPROM) on core0 can't stall or crash it. c1_main goes to a .time_critical
+// section like the RP2040 flash driver, which the linker script copies to RAM at boot.
+
+#include <quantum.h>
+
+#ifdef DUAL_CORE_MATRIX_ENABLE
+
+#  include "hardware/sync.h"
+
+#  ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#  endif
+
+#  ifndef MATRIX_IO_DELAY
+#    define MATRIX_IO_DELAY 30
+#  endif
+
+// must be power of 2
+#  ifndef CORE1_EVENT_BUFFER_SIZE
+#    define CORE1_EVENT_BUFFER_SIZE 64
+#  endif
+
+#  define EVENT_PRESSED 0x8000
+#  define EVENT(row, col, pressed) (((row) << 8) | (col) | ((pressed) ? EVENT_PRESSED : 0))
+#  define EVENT_ROW(event) (((event) >> 8) & 0x7f)
+#  define EVENT_COL(event) ((event) & 0xff)
+
+// not const, core1 must not read flash
+static pin_t row_pins[MATRIX_ROWS] = MATRIX_ROW_PINS;
+static pin_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
+
+// single producer (core1), single consumer (core0) ring
+static uint16_t events[CORE1_EVENT_BUFFER_SIZE];
+static volatile uint32_t event_head;
+static volatile uint32_t event_tail;
+
+static volatile bool core1_start;
+
+// core1 only
+static matrix_row_t debounced[MATRIX_ROWS];
+static uint32_t changed_at_us[MATRIX_ROWS][MATRIX_COLS];
+
+static inline __attribute__((always_inline)) uint32_t time_us(void) { return TIMER->TIMERAWL; }
+
+static inline __attribute__((always_inline)) void wait_us_core1(uint32_t us) {
+  uint32_t start = time_us();
+  while (time_us() - start < us) {
+  }
+}
+
+static inline __attribute__((always_inline)) void publish(uint16_t event) {
+  // wait for core0 rather than losing an edge
+  while (event_head - event_tail >= CORE1_EVENT_BUFFER_SIZE) {
+  }
+  events[event_head & (CORE1_EVENT_BUFFER_SIZE - 1)] = event;
+  __DMB();
+  event_head++;
+}
+
+static inline __attribute__((always_inline)) matrix_row_t read_row(uint8_t row) {
+  // COL2ROW: drive the row low, columns are pulled up
+  SIO->GPIO_OE_SET = 1UL << PAL_PAD(row_pins[row]);
+  wait_us_core1(1);
+  uint32_t in = SIO->GPIO_IN;
+  SIO->GPIO_OE_CLR = 1UL << PAL_PAD(row_pins[row]);
+  matrix_row_t cols = 0;
+  for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+    if (!(in & (1UL << PAL_PAD(col_pins[col])))) {
+      cols |= (matrix_row_t)1 << col;
+    }
+  }
+  // unselected row is pulled up again before the next one is driven
+  wait_us_core1(MATRIX_IO_DELAY);
+  return cols;
+}
+
+// eager per key debounce, same as sym_eager_pk. helpers above are always_inline so that
+// nothing is called in flash.
+void __no_inline_not_in_flash_func(c1_main)(void) {
+  while (!core1_start) {
+  }
+  for (;;) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+      matrix_row_t changes = read_row(row) ^ debounced[row];
+      if (!changes) {
+        continue;
+      }
+      uint32_t now = time_us();
+      for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        matrix_row_t mask = (matrix_row_t)1 << col;
+        if (!(changes & mask) || now - changed_at_us[row][col] < DEBOUNCE * 1000) {
+          continue;
+        }
+        debounced[row] ^= mask;
+        changed_at_us[row][col] = now;
+        publish(EVENT(row, col, debounced[row] & mask));
+      }
+    }
+  }
+}
+
+void matrix_init_custom(void) {
+  for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+    setPinInputHigh(row_pins[row]);
+    SIO->GPIO_OUT_CLR = 1UL << PAL_PAD(row_pins[row]);
+  }
+  for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+    setPinInputHigh(col_pins[col]);
+  }
+  core1_start = true;
+}
+
+// applies key changes from core1 in order. a key that changes again in the same
+// scan is left for the next one, so that every edge reaches the keymap.
+bool matrix_scan_custom(matrix_row_t current_matrix[]) {
+  matrix_row_t changed[MATRIX_ROWS] = {0};
+  bool any = false;
+  while (event_tail != event_head) {
+    __DMB();
+    uint16_t event = events[event_tail & (CORE1_EVENT_BUFFER_SIZE - 1)];
+    uint8_t row = EVENT_ROW(event);
+    matrix_row_t mask = (matrix_row_t)1 << EVENT_COL(event);
+    if (changed[row] & mask) {
+      break;
+    }
+    changed[row] |= mask;
+    if (event & EVENT_PRESSED) {
+      current_matrix[row] |= mask;
+    } else {
+      current_matrix[row] &= ~mask;
+    }
+    any = true;
+    event_tail++;
+  }
+  return any;
+}
+
+#endif
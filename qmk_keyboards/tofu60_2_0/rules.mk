@@ -3,3 +3,13 @@ DEBOUNCE_TYPE = sym_eager_pk
 
 # gcc optimization
 OPT = 2
+
+# matrix scan and debounce on core1, not verified on hardware yet
+DUAL_CORE_MATRIX_ENABLE = no
+ifeq ($(strip $(DUAL_CORE_MATRIX_ENABLE)), yes)
+    CUSTOM_MATRIX = lite
+    # debounced on core1
+    DEBOUNCE_TYPE = none
+    SRC += matrix_core1.c
+    OPT_DEFS += -DDUAL_CORE_MATRIX_ENABLE
+endif
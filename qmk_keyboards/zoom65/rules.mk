@@ -10,3 +10,7 @@ SRC += lib/radial_controller.c
 
 # gcc optimization
 OPT = s  # optimize for size
+
+# read each column port once per row
+CUSTOM_MATRIX = lite
+SRC += lib/port_matrix.c
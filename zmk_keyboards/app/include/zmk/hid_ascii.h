@@ -1,28 +1,30 @@
 #pragma once
 
+#include <stdint.h>
 #include <dt-bindings/zmk/keys.h>
 
 #define _K(key) HID_USAGE_KEY_KEYBOARD_##key
 #define _S(key) (_K(key) + 0x80)
 
-static const uint8_t hid_ascii_table = {
-  _K(SPAEBAR),                        // 0x20
+// keyboard usage of ASCII 0x20-0x7E, bit 7 = with shift
+static const uint8_t hid_ascii_table[] = {
+  _K(SPACEBAR),                       // 0x20
   _S(1_AND_EXCLAMATION),              // 0x21
   _S(APOSTROPHE_AND_QUOTE),           // 0x22
   _S(3_AND_HASH),                     // 0x23
   _S(4_AND_DOLLAR),                   // 0x24
   _S(5_AND_PERCENT),                  // 0x25
   _S(7_AND_AMPERSAND),                // 0x26
-  _S(APOSTROPHE_AND_QUOTE),           // 0x27
+  _K(APOSTROPHE_AND_QUOTE),           // 0x27
   _S(9_AND_LEFT_PARENTHESIS),         // 0x28
   _S(0_AND_RIGHT_PARENTHESIS),        // 0x29
   _S(8_AND_ASTERISK),                 // 0x2A
   _S(EQUAL_AND_PLUS),                 // 0x2B
   _K(COMMA_AND_LESS_THAN),            // 0x2C
-  -K(MINUS_AND_UNDERSCORE),           // 0x2D
+  _K(MINUS_AND_UNDERSCORE),           // 0x2D
   _K(PERIOD_AND_GREATER_THAN),        // 0x2E
   _K(SLASH_AND_QUESTION_MARK),        // 0x2F
-  _K(0_AND_RIGHT_PARENTHESIS)         // 0x30
+  _K(0_AND_RIGHT_PARENTHESIS),        // 0x30
   _K(1_AND_EXCLAMATION),              // 0x31
   _K(2_AND_AT),                       // 0x32
   _K(3_AND_HASH),                     // 0x33
@@ -103,12 +105,18 @@ static const uint8_t hid_ascii_table = {
   _S(GRAVE_ACCENT_AND_TILDE)          // 0x7E
 };
 
-inline static uint32_t ascii2keycode(char c) {
-  if (c == 0x0d) return RET;
-  if (c >= 0x20 && c <= 0x7e) {
-    uint8_t usage = hid_ascii_table[c - 0x20];
-    return usage & 0x80 ? LS(ZMK_HID_USAGE(HID_USAGE_KEY, usage & 0x7f))
-                        : ZMK_HID_USAGE(HID_USAGE_KEY, usage);
-  }
+// keyboard usage | 0x80 if shifted, 0 = not typeable. a lone '\r' is Enter too, callers fold
+// CRLF into one.
+inline static uint8_t ascii2usage(char c) {
+  if (c == '\n' || c == '\r') return _K(RETURN_ENTER);
+  if (c == '\t') return _K(TAB);
+  if (c >= 0x20 && c <= 0x7e) return hid_ascii_table[c - 0x20];
   return 0;
 }
+
+inline static uint32_t ascii2keycode(char c) {
+  uint8_t usage = ascii2usage(c);
+  if (usage == 0) return 0;
+  return usage & 0x80 ? LS(ZMK_HID_USAGE(HID_USAGE_KEY, usage & 0x7f))
+                      : ZMK_HID_USAGE(HID_USAGE_KEY, usage);
+}
@@ -14,6 +14,8 @@
 #include <dt-bindings/zmk/hid_usage.h>
 #include <dt-bindings/zmk/hid_usage_pages.h>
 
+#include <zmk/keymap_hid_chunk.h>
+
 #ifndef HID_USAGE_PAGE16
 #define HID_USAGE_PAGE16(page, page2)                                                              \
     HID_ITEM(HID_ITEM_TAG_USAGE_PAGE, HID_ITEM_TYPE_GLOBAL, 2), page, page2
@@ -23,8 +25,6 @@
 #define HID_USAGE16(page, page2) HID_ITEM(HID_ITEM_TAG_USAGE, HID_ITEM_TYPE_LOCAL, 2), page, page2
 #endif
 
-#define KEYMAP_HID_MAX_BYTES 1
-
 #define KEYMAP_HID_REPORT_ID 0x42
 
 static const uint8_t zmk_keymap_hid_report_desc[] = {
@@ -57,11 +57,79 @@ static const uint8_t zmk_keymap_hid_report_desc[] = {
     HID_END_COLLECTION,
 };
 
-struct zmk_keymap_hid_sample_report_body {
-    uint8_t data[KEYMAP_HID_MAX_BYTES];
-} __packed;
+/*
+ * keymap HID protocol
+ *
+ * a message is split into chunks, one chunk per report, see zmk/keymap_hid_chunk.h.
+ * request message is a batch of commands:
+ *   | cmd | len | data[len] | cmd | len | data[len] | ...
+ * response message has one entry per command:
+ *   | cmd | status | len | data[len] | ...
+ * multi-byte values are little endian.
+ */
 
-struct zmk_keymap_hid_sample_report {
+#define KEYMAP_HID_PROTOCOL_VERSION 1
+
+// behavior local id(2) + param1(4) + param2(4)
+#define KEYMAP_HID_BINDING_BYTES 10
+
+enum zmk_keymap_hid_cmd {
+    // -> version(1), layers(1), keys(1), max message bytes(2)
+    KEYMAP_HID_CMD_GET_INFO = 0x01,
+    // layer(1), position(1), count(1) -> layer(1), position(1), count(1), bindings
+    KEYMAP_HID_CMD_GET_BINDINGS = 0x02,
+    // layer(1), position(1), count(1), bindings ->
+    KEYMAP_HID_CMD_SET_BINDINGS = 0x03,
+    // config id(1) -> config id(1), value(4)
+    KEYMAP_HID_CMD_GET_CONFIG = 0x04,
+    // -> , writes changed bindings to settings now instead of after debounce
+    KEYMAP_HID_CMD_SAVE_BINDINGS = 0x05,
+    // -> , reverts bindings to the last saved state
+    KEYMAP_HID_CMD_DISCARD_BINDINGS = 0x06,
+};
+
+enum zmk_keymap_hid_status {
+    KEYMAP_HID_STATUS_OK = 0x00,
+    KEYMAP_HID_STATUS_UNKNOWN_CMD = 0x01,
+    KEYMAP_HID_STATUS_INVALID_ARG = 0x02,
+    KEYMAP_HID_STATUS_NO_SPACE = 0x03,
+    KEYMAP_HID_STATUS_FAILED = 0x04,
+};
+
+enum zmk_keymap_hid_config_id {
+    KEYMAP_HID_CONFIG_HIGHEST_LAYER = 0x01,
+    KEYMAP_HID_CONFIG_BLE_PROFILE = 0x02,
+    KEYMAP_HID_CONFIG_USB_HOST_OS = 0x03,
+};
+
+struct zmk_keymap_hid_report {
     uint8_t report_id;
-    struct zmk_keymap_hid_sample_report_body body;
+    struct zmk_keymap_hid_report_body body;
 } __packed;
+
+// handles a request message, returns length of the response message.
+// must be called from the system work queue.
+size_t zmk_keymap_hid_handle_message(const uint8_t *request, size_t len, uint8_t *response,
+                                     size_t response_size);
+
+struct zmk_keymap_usb_hid_stats {
+    uint32_t queued;
+    uint32_t sent;
+    uint32_t busy;    // queue was full, the caller retries
+    uint32_t dropped; // responses given up, full queue until the deadline or bus down
+    uint32_t failed;  // endpoint write error
+    uint8_t max_depth;
+};
+
+// queues a report for the USB IN endpoint without blocking, -EAGAIN when the queue is full.
+int zmk_keymap_hid_usb_hid_send_report(const uint8_t *report, size_t len);
+struct zmk_keymap_usb_hid_stats zmk_keymap_hid_usb_hid_get_stats(void);
+
+struct zmk_keymap_hog_stats {
+    uint32_t queued;
+    uint32_t rejected;  // requests refused while another one was already pending
+    uint32_t sent;      // notifications
+    uint32_t dropped;   // not connected or notify error
+};
+
+struct zmk_keymap_hog_stats zmk_keymap_hid_hog_get_stats(void);
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2020 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+
+/*
+ * keymap HID message framing, no dependency on the keymap or the HID transports.
+ *
+ * a message is split into chunks, one chunk per report.
+ * chunk: | seq | ctrl | len | payload[len] |
+ *   seq:  message sequence number, a response echoes the seq of its request
+ *   ctrl: bit7 more chunks follow, bit0-6 chunk index in the message
+ */
+
+// fits in a notification with ZMK's default ATT MTU (65)
+#define KEYMAP_HID_MAX_BYTES 62
+
+#define KEYMAP_HID_CHUNK_HEADER_BYTES 3
+#define KEYMAP_HID_CHUNK_MAX_PAYLOAD (KEYMAP_HID_MAX_BYTES - KEYMAP_HID_CHUNK_HEADER_BYTES)
+#define KEYMAP_HID_CHUNK_MORE BIT(7)
+#define KEYMAP_HID_CHUNK_INDEX_MASK 0x7f
+
+struct zmk_keymap_hid_report_body {
+    uint8_t seq;
+    uint8_t ctrl;
+    uint8_t len;
+    uint8_t payload[KEYMAP_HID_CHUNK_MAX_PAYLOAD];
+} __packed;
+
+struct zmk_keymap_hid_assembler {
+    uint8_t seq;
+    uint8_t next_index;
+    size_t len;
+    uint8_t buf[CONFIG_ZMK_KEYMAP_HID_MAX_MESSAGE_BYTES];
+};
+
+// returns 1 when a message is completed, 0 when more chunks are needed, negative on error.
+int zmk_keymap_hid_assemble(struct zmk_keymap_hid_assembler *assembler,
+                            const struct zmk_keymap_hid_report_body *chunk);
+
+// fills a chunk of message at offset, returns number of payload bytes consumed.
+size_t zmk_keymap_hid_fill_chunk(struct zmk_keymap_hid_report_body *chunk, uint8_t seq,
+                                 const uint8_t *message, size_t len, size_t offset,
+                                 size_t max_payload);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+
+enum zmk_perf_event {
+  ZMK_PERF_EVENT_POSITION,
+  ZMK_PERF_EVENT_KEYCODE,
+  ZMK_PERF_EVENT_LAYER,
+  ZMK_PERF_EVENT_COUNT,
+};
+
+// log-linear latency histogram, 4 buckets per power of 2 microseconds
+#define ZMK_PERF_LATENCY_SUB_BUCKETS 4
+#define ZMK_PERF_LATENCY_BUCKETS (21 * ZMK_PERF_LATENCY_SUB_BUCKETS)
+
+struct zmk_perf_dispatch_stats {
+  uint32_t count;
+  uint32_t total_us;
+  uint32_t max_us;
+};
+
+struct zmk_perf_stats {
+  int64_t since_ms;
+  // kscan callbacks, counted as raised position events
+  uint32_t kscan_events;
+  // kscan callback to event dispatch, includes the kscan message queue
+  uint32_t kscan_delay_max_ms;
+  // dispatch through all listeners, events captured by a behavior are not counted
+  struct zmk_perf_dispatch_stats dispatch[ZMK_PERF_EVENT_COUNT];
+  // keycode events that went through all listeners, by the endpoint selected at the time.
+  // the hid listener sends one report for each of them.
+  uint32_t usb_keycodes;
+  uint32_t ble_keycodes;
+  uint32_t latency_max_us;
+  uint32_t latency[ZMK_PERF_LATENCY_BUCKETS];
+};
+
+void zmk_perf_snapshot(struct zmk_perf_stats *stats);
+void zmk_perf_reset(void);
+// upper bound of the bucket holding the percentile, 0 = no samples
+uint32_t zmk_perf_latency_percentile_us(const struct zmk_perf_stats *stats, uint8_t percent);
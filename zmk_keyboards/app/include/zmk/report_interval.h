@@ -0,0 +1,4 @@
+#pragma once
+
+// USB poll interval or BLE connection interval of the selected endpoint in ms, 0 = unknown
+int zmk_report_interval_ms(void);
@@ -2,7 +2,28 @@
 
 #include <zephyr/usb/usb_device.h>
 
-enum usb_host_os { USB_HOST_OS_UNDEFINED, USB_HOST_OS_DARWIN, USB_HOST_OS_UNKNOWN };
+enum usb_host_os {
+  USB_HOST_OS_UNDEFINED,
+  USB_HOST_OS_DARWIN,
+  USB_HOST_OS_WINDOWS,
+  USB_HOST_OS_UNKNOWN,
+};
+
+// signature matcher of HID class requests, zero initialized state is reset
+struct zmk_usb_host_os_matcher {
+  uint32_t rejected;              // bit per signature
+  enum usb_host_os completed_os;  // os of the last completed signature
+  uint8_t step;
+  uint8_t last_bRequest;
+  uint16_t last_wValue;
+};
+
+void zmk_usb_host_os_match_reset(struct zmk_usb_host_os_matcher *matcher);
+// feeds a request, returns the os when certain, USB_HOST_OS_UNDEFINED otherwise.
+enum usb_host_os zmk_usb_host_os_match(struct zmk_usb_host_os_matcher *matcher,
+                                       const struct usb_setup_packet *setup);
+// os at the end of the setup, USB_HOST_OS_UNKNOWN if no signature completed.
+enum usb_host_os zmk_usb_host_os_match_completed(const struct zmk_usb_host_os_matcher *matcher);
 
 enum usb_host_os zmk_usb_host_os_detected(void);
 void zmk_usb_host_os_trace_hid_setup(struct usb_setup_packet *setup);
@@ -8,42 +8,132 @@
 
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
 #include <drivers/behavior.h>
 
 #include <zmk/behavior.h>
 #include <zmk/hid.h>
 #include <zmk/endpoints.h>
+#include <zmk/report_interval.h>
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 #if DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT)
+
+#  define DIAL_MAX_X10 3600
+
 struct behavior_rc_dial_config {
   int degrees_per_click_x10;
+  int repeat_interval_ms;
+  int acceleration_delay_ms;
+  int acceleration_time_ms;
+  int acceleration_max;
+};
+
+struct behavior_rc_dial_data {
+  const struct device *dev;
+  struct k_work_delayable repeat_work;
+  int64_t pressed_at;
 };
 
-static int behavior_rc_dial_init(const struct device *dev) { return 0; }
+// rotation shared by all dial instances, flushed at most once per report interval
+static int32_t pending_x10;
+static int64_t last_flush;
+
+static void flush_dial(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(flush_work, flush_dial);
+
+static void flush_dial(struct k_work *work) {
+  if (pending_x10 == 0) {
+    return;
+  }
+  int16_t value = CLAMP(pending_x10, -DIAL_MAX_X10, DIAL_MAX_X10);
+  pending_x10 -= value;
+  last_flush = k_uptime_get();
+  LOG_DBG("radial controller dial rotate %d (x10)degrees", value);
+  zmk_hid_radial_controller_dial_rotate(value);
+  zmk_endpoints_send_radial_controller_report();
+  zmk_hid_radial_controller_dial_rotate(0);
+  if (pending_x10 != 0) {
+    k_work_reschedule(&flush_work, K_MSEC(zmk_report_interval_ms()));
+  }
+}
+
+static void rotate(int x10degree) {
+  pending_x10 += x10degree;
+  if (k_work_delayable_is_pending(&flush_work)) {
+    return;
+  }
+  // first movement is sent immediately
+  int64_t wait = last_flush + zmk_report_interval_ms() - k_uptime_get();
+  k_work_schedule(&flush_work, wait > 0 ? K_MSEC(wait) : K_NO_WAIT);
+}
+
+// linear from 1 to acceleration-max, starting after acceleration-delay-ms
+static int acceleration(const struct behavior_rc_dial_config *cfg, int64_t held_ms) {
+  if (cfg->acceleration_max <= 1 || held_ms <= cfg->acceleration_delay_ms) {
+    return 1;
+  }
+  int64_t t = held_ms - cfg->acceleration_delay_ms;
+  if (cfg->acceleration_time_ms <= 0 || t >= cfg->acceleration_time_ms) {
+    return cfg->acceleration_max;
+  }
+  return 1 + (cfg->acceleration_max - 1) * t / cfg->acceleration_time_ms;
+}
+
+static void repeat_rotate(struct k_work *work) {
+  struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+  struct behavior_rc_dial_data *data =
+    CONTAINER_OF(dwork, struct behavior_rc_dial_data, repeat_work);
+  const struct behavior_rc_dial_config *cfg = data->dev->config;
+  rotate(cfg->degrees_per_click_x10 * acceleration(cfg, k_uptime_get() - data->pressed_at));
+  k_work_reschedule(&data->repeat_work, K_MSEC(cfg->repeat_interval_ms));
+}
+
+static int behavior_rc_dial_init(const struct device *dev) {
+  struct behavior_rc_dial_data *data = dev->data;
+  data->dev = dev;
+  k_work_init_delayable(&data->repeat_work, repeat_rotate);
+  return 0;
+}
 
 static int on_keymap_binding_pressed(struct zmk_behavior_binding *binding,
                                      struct zmk_behavior_binding_event event) {
   const struct device *dev = device_get_binding(binding->behavior_dev);
   const struct behavior_rc_dial_config *cfg = dev->config;
-  LOG_DBG("radial controller dial rotate %d (x10)degrees", cfg->degrees_per_click_x10);
-  zmk_hid_radial_controller_dial_rotate(cfg->degrees_per_click_x10);
-  int ret = zmk_endpoints_send_radial_controller_report();
-  zmk_hid_radial_controller_dial_rotate(0);
-  return ret;
+  struct behavior_rc_dial_data *data = dev->data;
+  rotate(cfg->degrees_per_click_x10);
+  if (cfg->repeat_interval_ms > 0) {
+    data->pressed_at = k_uptime_get();
+    k_work_reschedule(&data->repeat_work, K_MSEC(cfg->repeat_interval_ms));
+  }
+  return ZMK_BEHAVIOR_OPAQUE;
+}
+
+static int on_keymap_binding_released(struct zmk_behavior_binding *binding,
+                                      struct zmk_behavior_binding_event event) {
+  const struct device *dev = device_get_binding(binding->behavior_dev);
+  struct behavior_rc_dial_data *data = dev->data;
+  k_work_cancel_delayable(&data->repeat_work);
+  return ZMK_BEHAVIOR_OPAQUE;
 }
 
-static const struct behavior_driver_api behavior_rc_dial_driver_api = {.binding_pressed =
-                                                                         on_keymap_binding_pressed};
+static const struct behavior_driver_api behavior_rc_dial_driver_api = {
+  .binding_pressed = on_keymap_binding_pressed, .binding_released = on_keymap_binding_released};
 
-#  define RC_DIAL_INST(n)                                                                       \
-    static const struct behavior_rc_dial_config behavior_rc_dial_config_##n = {                 \
-      .degrees_per_click_x10 = DT_INST_PROP(n, degrees_per_click_x10)};                         \
-    BEHAVIOR_DT_INST_DEFINE(n, behavior_rc_dial_init, NULL, NULL, &behavior_rc_dial_config_##n, \
-                            POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,                   \
-                            &behavior_rc_dial_driver_api);
+#  define RC_DIAL_INST(n)                                                               \
+    static struct behavior_rc_dial_data behavior_rc_dial_data_##n;                      \
+    static const struct behavior_rc_dial_config behavior_rc_dial_config_##n = {         \
+      .degrees_per_click_x10 = DT_INST_PROP(n, degrees_per_click_x10),                  \
+      .repeat_interval_ms = DT_INST_PROP(n, repeat_interval_ms),                        \
+      .acceleration_delay_ms = DT_INST_PROP(n, acceleration_delay_ms),                  \
+      .acceleration_time_ms = DT_INST_PROP(n, acceleration_time_ms),                    \
+      .acceleration_max = DT_INST_PROP(n, acceleration_max)};                           \
+    BEHAVIOR_DT_INST_DEFINE(n, behavior_rc_dial_init, NULL, &behavior_rc_dial_data_##n, \
+                            &behavior_rc_dial_config_##n, POST_KERNEL,                  \
+                            CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &behavior_rc_dial_driver_api);
 
 DT_INST_FOREACH_STATUS_OKAY(RC_DIAL_INST)
 
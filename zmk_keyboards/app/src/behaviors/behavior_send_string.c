@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2020 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_behavior_send_string
+
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <drivers/behavior.h>
+#include <dt-bindings/zmk/modifiers.h>
+
+#include <zmk/behavior.h>
+#include <zmk/hid.h>
+#include <zmk/hid_ascii.h>
+#include <zmk/endpoints.h>
+#include <zmk/report_interval.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#if DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT)
+
+#  if IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_NKRO)
+#    define MAX_HELD_KEYS UINT8_MAX
+#  else
+#    define MAX_HELD_KEYS CONFIG_ZMK_HID_KEYBOARD_REPORT_SIZE
+#  endif
+
+// well below the shortest typematic delay of common hosts
+#  define MAX_HOLD_MS 100
+
+struct behavior_send_string_config {
+  const char *text;
+};
+
+// one string is typed at a time, shared by all instances
+static struct {
+  const char *text;
+  size_t pos;
+  uint32_t held[4];
+  uint8_t held_count;
+  bool shift;
+  int64_t held_since;
+} typing;
+
+static void type_next(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(type_work, type_next);
+
+static bool is_held(uint8_t usage) { return typing.held[usage / 32] & BIT(usage % 32); }
+
+static void release_all(void) {
+  for (uint8_t usage = 0; usage < 128; usage++) {
+    if (is_held(usage)) {
+      zmk_hid_keyboard_release(usage);
+    }
+  }
+  if (typing.shift) {
+    zmk_hid_unregister_mods(MOD_LSFT);
+  }
+  memset(typing.held, 0, sizeof(typing.held));
+  typing.held_count = 0;
+  typing.shift = false;
+}
+
+static void press(uint8_t usage, bool shift) {
+  if (typing.held_count == 0) {
+    if (shift) {
+      zmk_hid_register_mods(MOD_LSFT);
+    }
+    typing.shift = shift;
+    typing.held_since = k_uptime_get();
+  }
+  zmk_hid_keyboard_press(usage);
+  typing.held[usage / 32] |= BIT(usage % 32);
+  typing.held_count++;
+}
+
+// a key can stay down while other keys are typed, unless it has to be typed again or the
+// shift state changes
+static bool needs_release(uint8_t usage, bool shift) {
+  return typing.held_count > 0 &&
+         (is_held(usage) || shift != typing.shift || typing.held_count >= MAX_HELD_KEYS ||
+          k_uptime_get() - typing.held_since > MAX_HOLD_MS);
+}
+
+// sends one report per call, either the next run of new key presses or a release of
+// everything held
+static void type_next(struct k_work *work) {
+  bool changed = false;
+  uint8_t last_usage = 0;
+  while (typing.text[typing.pos] != '\0') {
+    if (typing.text[typing.pos] == '\r' && typing.text[typing.pos + 1] == '\n') {
+      // CRLF is one Enter
+      typing.pos++;
+      continue;
+    }
+    uint8_t code = ascii2usage(typing.text[typing.pos]);
+    if (code == 0) {
+      LOG_WRN("send string: skipping 0x%02x", typing.text[typing.pos]);
+      typing.pos++;
+      continue;
+    }
+    uint8_t usage = code & 0x7f;
+    bool shift = code & 0x80;
+    if (needs_release(usage, shift)) {
+      if (!changed) {
+        release_all();
+        changed = true;
+      }
+      break;
+    }
+    // host reads the keys of a report in usage order
+    if (usage <= last_usage) {
+      break;
+    }
+    press(usage, shift);
+    last_usage = usage;
+    changed = true;
+    typing.pos++;
+  }
+  if (!changed) {
+    if (typing.held_count == 0) {
+      typing.text = NULL;
+      return;
+    }
+    release_all();
+  }
+  zmk_endpoints_send_report(HID_USAGE_KEY);
+  k_work_reschedule(&type_work, K_MSEC(MAX(zmk_report_interval_ms(), 1)));
+}
+
+static int behavior_send_string_init(const struct device *dev) { return 0; }
+
+static int on_keymap_binding_pressed(struct zmk_behavior_binding *binding,
+                                     struct zmk_behavior_binding_event event) {
+  const struct device *dev = device_get_binding(binding->behavior_dev);
+  const struct behavior_send_string_config *cfg = dev->config;
+  if (typing.text != NULL) {
+    LOG_DBG("send string: busy");
+    return ZMK_BEHAVIOR_OPAQUE;
+  }
+  typing.text = cfg->text;
+  typing.pos = 0;
+  k_work_reschedule(&type_work, K_NO_WAIT);
+  return ZMK_BEHAVIOR_OPAQUE;
+}
+
+static int on_keymap_binding_released(struct zmk_behavior_binding *binding,
+                                      struct zmk_behavior_binding_event event) {
+  return ZMK_BEHAVIOR_OPAQUE;
+}
+
+static const struct behavior_driver_api behavior_send_string_driver_api = {
+  .binding_pressed = on_keymap_binding_pressed, .binding_released = on_keymap_binding_released};
+
+#  define SEND_STRING_INST(n)                                                           \
+    static const struct behavior_send_string_config behavior_send_string_config_##n = { \
+      .text = DT_INST_PROP(n, text)};                                                   \
+    BEHAVIOR_DT_INST_DEFINE(n, behavior_send_string_init, NULL, NULL,                   \
+                            &behavior_send_string_config_##n, POST_KERNEL,              \
+                            CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,                        \
+                            &behavior_send_string_driver_api);
+
+DT_INST_FOREACH_STATUS_OKAY(SEND_STRING_INST)
+
+#endif /* DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT) */
@@ -0,0 +1,115 @@
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <zmk/activity.h>
+#include <zmk/ble.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/activity_state_changed.h>
+#include <zmk/events/position_state_changed.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+static const struct bt_le_conn_param active_param =
+  BT_LE_CONN_PARAM_INIT(CONFIG_ZMK_BLE_ADAPTIVE_CONN_ACTIVE_INTERVAL_MIN,
+                        CONFIG_ZMK_BLE_ADAPTIVE_CONN_ACTIVE_INTERVAL_MAX,
+                        CONFIG_ZMK_BLE_ADAPTIVE_CONN_ACTIVE_LATENCY,
+                        CONFIG_ZMK_BLE_ADAPTIVE_CONN_ACTIVE_TIMEOUT);
+
+static const struct bt_le_conn_param idle_param =
+  BT_LE_CONN_PARAM_INIT(CONFIG_ZMK_BLE_ADAPTIVE_CONN_IDLE_INTERVAL_MIN,
+                        CONFIG_ZMK_BLE_ADAPTIVE_CONN_IDLE_INTERVAL_MAX,
+                        CONFIG_ZMK_BLE_ADAPTIVE_CONN_IDLE_LATENCY,
+                        CONFIG_ZMK_BLE_ADAPTIVE_CONN_IDLE_TIMEOUT);
+
+// a request the host rejected or changed is not repeated before this
+#define REQUEST_HOLDOFF_MS 10000
+
+static bool requested_active;
+static int64_t requested_at = -REQUEST_HOLDOFF_MS;
+
+// anything the host picked from the active range counts, it doesn't have to be the minimum.
+static bool is_active(uint16_t interval, uint16_t latency) {
+  return interval <= CONFIG_ZMK_BLE_ADAPTIVE_CONN_ACTIVE_INTERVAL_MAX &&
+         latency <= CONFIG_ZMK_BLE_ADAPTIVE_CONN_ACTIVE_LATENCY;
+}
+
+// decided from the parameters in use, the host may apply other values than requested, and
+// starts a connection with its own (ZMK asks for latency 30 on connect).
+static bool param_is_active(struct bt_conn *conn) {
+  struct bt_conn_info info;
+  if (bt_conn_get_info(conn, &info) || info.type != BT_CONN_TYPE_LE) {
+    return false;
+  }
+  return is_active(info.le.interval, info.le.latency);
+}
+
+static void request_param(bool to_active) {
+  struct bt_conn *conn = zmk_ble_active_profile_conn();
+  if (conn == NULL) {
+    return;
+  }
+  int64_t now = k_uptime_get();
+  if (param_is_active(conn) == to_active ||
+      (requested_active == to_active && now - requested_at < REQUEST_HOLDOFF_MS)) {
+    bt_conn_unref(conn);
+    return;
+  }
+  int err = bt_conn_le_param_update(conn, to_active ? &active_param : &idle_param);
+  bt_conn_unref(conn);
+  if (err && err != -EALREADY) {
+    LOG_WRN("adaptive conn: failed to request %s parameters (%d)", to_active ? "active" : "idle",
+            err);
+    return;
+  }
+  requested_active = to_active;
+  requested_at = now;
+  LOG_DBG("adaptive conn: %s requested", to_active ? "active" : "idle");
+}
+
+static void relax(struct k_work *work) { request_param(false); }
+
+static K_WORK_DELAYABLE_DEFINE(relax_work, relax);
+
+static int adaptive_conn_listener(const zmk_event_t *eh) {
+  const struct zmk_position_state_changed *position = as_zmk_position_state_changed(eh);
+  if (position != NULL) {
+    if (position->state) {
+      // the first keystroke still goes out on the next idle connection event,
+      // the host switches to the short interval while it is being typed.
+      request_param(true);
+      k_work_reschedule(&relax_work, K_MSEC(CONFIG_ZMK_BLE_ADAPTIVE_CONN_IDLE_MS));
+    }
+    return ZMK_EV_EVENT_BUBBLE;
+  }
+  if (zmk_activity_get_state() != ZMK_ACTIVITY_ACTIVE) {
+    k_work_reschedule(&relax_work, K_NO_WAIT);
+  }
+  return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(ble_adaptive_conn, adaptive_conn_listener);
+ZMK_SUBSCRIPTION(ble_adaptive_conn, zmk_position_state_changed);
+ZMK_SUBSCRIPTION(ble_adaptive_conn, zmk_activity_state_changed);
+
+static void connected(struct bt_conn *conn, uint8_t err) {
+  if (err) {
+    return;
+  }
+  requested_at = -REQUEST_HOLDOFF_MS;
+  k_work_reschedule(&relax_work, K_MSEC(CONFIG_ZMK_BLE_ADAPTIVE_CONN_IDLE_MS));
+}
+
+static void le_param_updated(struct bt_conn *conn, uint16_t interval, uint16_t latency,
+                             uint16_t timeout) {
+  LOG_DBG("adaptive conn: interval %u latency %u timeout %u", interval, latency, timeout);
+  // got what was asked for, a later change of mind doesn't have to wait for the holdoff
+  if (is_active(interval, latency) == requested_active) {
+    requested_at = -REQUEST_HOLDOFF_MS;
+  }
+}
+
+BT_CONN_CB_DEFINE(adaptive_conn_callbacks) = {
+  .connected = connected,
+  .le_param_updated = le_param_updated,
+};
@@ -0,0 +1,47 @@
+#include <errno.h>
+#include <string.h>
+#include <zephyr/logging/log.h>
+
+#include <zmk/keymap_hid_chunk.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+int zmk_keymap_hid_assemble(struct zmk_keymap_hid_assembler *assembler,
+                            const struct zmk_keymap_hid_report_body *chunk) {
+  uint8_t index = chunk->ctrl & KEYMAP_HID_CHUNK_INDEX_MASK;
+  if (chunk->len > KEYMAP_HID_CHUNK_MAX_PAYLOAD) {
+    return -EINVAL;
+  }
+  if (index == 0) {
+    // first chunk always starts a new message
+    assembler->seq = chunk->seq;
+    assembler->len = 0;
+  } else if (chunk->seq != assembler->seq || index != assembler->next_index) {
+    LOG_WRN("keymap hid: lost chunk seq:%d index:%d", chunk->seq, index);
+    assembler->next_index = 0;
+    return -EILSEQ;
+  }
+  if (assembler->len + chunk->len > sizeof(assembler->buf)) {
+    assembler->next_index = 0;
+    return -ENOMEM;
+  }
+  memcpy(&assembler->buf[assembler->len], chunk->payload, chunk->len);
+  assembler->len += chunk->len;
+  assembler->next_index = index + 1;
+  return (chunk->ctrl & KEYMAP_HID_CHUNK_MORE) ? 0 : 1;
+}
+
+size_t zmk_keymap_hid_fill_chunk(struct zmk_keymap_hid_report_body *chunk, uint8_t seq,
+                                 const uint8_t *message, size_t len, size_t offset,
+                                 size_t max_payload) {
+  max_payload = MIN(max_payload, KEYMAP_HID_CHUNK_MAX_PAYLOAD);
+  size_t size = MIN(len - offset, max_payload);
+  uint8_t index = offset / max_payload;
+  chunk->seq = seq;
+  chunk->ctrl = (index & KEYMAP_HID_CHUNK_INDEX_MASK) |
+                (offset + size < len ? KEYMAP_HID_CHUNK_MORE : 0);
+  chunk->len = size;
+  memcpy(chunk->payload, &message[offset], size);
+  memset(&chunk->payload[size], 0, KEYMAP_HID_CHUNK_MAX_PAYLOAD - size);
+  return size;
+}
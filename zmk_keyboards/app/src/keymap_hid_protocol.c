@@ -0,0 +1,219 @@
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+
+#include <zmk/behavior.h>
+#include <zmk/keymap.h>
+#include <zmk/keymap_hid.h>
+#if IS_ENABLED(CONFIG_ZMK_BLE)
+#  include <zmk/ble.h>
+#endif
+#if IS_ENABLED(CONFIG_ZMK_USB_HOST_OS)
+#  include <zmk/usb_host_os.h>
+#endif
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+// cmd(1) + status(1) + len(1)
+#define RESPONSE_HEADER_BYTES 3
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
+static void save_keymap(struct k_work *work) {
+  int err = zmk_keymap_save_changes();
+  if (err < 0) {
+    LOG_ERR("keymap hid: failed to save keymap (%d)", err);
+  }
+}
+
+// coalesces binding changes into one settings write
+static K_WORK_DELAYABLE_DEFINE(save_keymap_work, save_keymap);
+#endif
+
+static uint8_t get_info(const uint8_t *data, uint8_t len, uint8_t *out, uint8_t *out_len,
+                        size_t out_size) {
+  if (out_size < 5) {
+    return KEYMAP_HID_STATUS_NO_SPACE;
+  }
+  out[0] = KEYMAP_HID_PROTOCOL_VERSION;
+  out[1] = ZMK_KEYMAP_LAYERS_LEN;
+  out[2] = ZMK_KEYMAP_LEN;
+  sys_put_le16(CONFIG_ZMK_KEYMAP_HID_MAX_MESSAGE_BYTES, &out[3]);
+  *out_len = 5;
+  return KEYMAP_HID_STATUS_OK;
+}
+
+static bool check_range(const uint8_t *data, uint8_t len, zmk_keymap_layer_id_t *layer_id) {
+  if (len < 3) {
+    return false;
+  }
+  *layer_id = zmk_keymap_layer_index_to_id(data[0]);
+  return *layer_id != ZMK_KEYMAP_LAYER_ID_INVAL && data[1] + data[2] <= ZMK_KEYMAP_LEN;
+}
+
+static uint8_t get_bindings(const uint8_t *data, uint8_t len, uint8_t *out, uint8_t *out_len,
+                            size_t out_size) {
+  zmk_keymap_layer_id_t layer_id;
+  if (!check_range(data, len, &layer_id)) {
+    return KEYMAP_HID_STATUS_INVALID_ARG;
+  }
+  uint8_t count = data[2];
+  if (out_size < 3 + count * KEYMAP_HID_BINDING_BYTES) {
+    return KEYMAP_HID_STATUS_NO_SPACE;
+  }
+  memcpy(out, data, 3);
+  uint8_t *p = &out[3];
+  for (uint8_t i = 0; i < count; i++) {
+    const struct zmk_behavior_binding *binding =
+      zmk_keymap_get_layer_binding_at_idx(layer_id, data[1] + i);
+    sys_put_le16(binding && binding->behavior_dev
+                   ? zmk_behavior_get_local_id(binding->behavior_dev)
+                   : UINT16_MAX,
+                 p);
+    sys_put_le32(binding ? binding->param1 : 0, p + 2);
+    sys_put_le32(binding ? binding->param2 : 0, p + 6);
+    p += KEYMAP_HID_BINDING_BYTES;
+  }
+  *out_len = p - out;
+  return KEYMAP_HID_STATUS_OK;
+}
+
+static uint8_t set_bindings(const uint8_t *data, uint8_t len, uint8_t *out, uint8_t *out_len,
+                            size_t out_size) {
+  zmk_keymap_layer_id_t layer_id;
+  if (!check_range(data, len, &layer_id) || len != 3 + data[2] * KEYMAP_HID_BINDING_BYTES) {
+    return KEYMAP_HID_STATUS_INVALID_ARG;
+  }
+  const uint8_t *p = &data[3];
+  for (uint8_t i = 0; i < data[2]; i++, p += KEYMAP_HID_BINDING_BYTES) {
+    const char *name = zmk_behavior_find_behavior_name_from_local_id(sys_get_le16(p));
+    if (name == NULL) {
+      return KEYMAP_HID_STATUS_INVALID_ARG;
+    }
+    struct zmk_behavior_binding binding = {
+      .behavior_dev = name,
+      .param1 = sys_get_le32(p + 2),
+      .param2 = sys_get_le32(p + 6),
+    };
+    if (zmk_keymap_set_layer_binding_at_idx(layer_id, data[1] + i, binding) < 0) {
+      return KEYMAP_HID_STATUS_FAILED;
+    }
+  }
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
+  k_work_reschedule(&save_keymap_work, K_MSEC(CONFIG_ZMK_KEYMAP_HID_SAVE_DEBOUNCE_MS));
+#endif
+  *out_len = 0;
+  return KEYMAP_HID_STATUS_OK;
+}
+
+static uint8_t save_bindings(const uint8_t *data, uint8_t len, uint8_t *out, uint8_t *out_len,
+                             size_t out_size) {
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
+  k_work_cancel_delayable(&save_keymap_work);
+  if (zmk_keymap_save_changes() < 0) {
+    return KEYMAP_HID_STATUS_FAILED;
+  }
+  *out_len = 0;
+  return KEYMAP_HID_STATUS_OK;
+#else
+  return KEYMAP_HID_STATUS_UNKNOWN_CMD;
+#endif
+}
+
+static uint8_t discard_bindings(const uint8_t *data, uint8_t len, uint8_t *out, uint8_t *out_len,
+                                size_t out_size) {
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
+  k_work_cancel_delayable(&save_keymap_work);
+  if (zmk_keymap_discard_changes() < 0) {
+    return KEYMAP_HID_STATUS_FAILED;
+  }
+  *out_len = 0;
+  return KEYMAP_HID_STATUS_OK;
+#else
+  return KEYMAP_HID_STATUS_UNKNOWN_CMD;
+#endif
+}
+
+static uint8_t get_config(const uint8_t *data, uint8_t len, uint8_t *out, uint8_t *out_len,
+                          size_t out_size) {
+  uint32_t value;
+  if (len < 1) {
+    return KEYMAP_HID_STATUS_INVALID_ARG;
+  }
+  if (out_size < 5) {
+    return KEYMAP_HID_STATUS_NO_SPACE;
+  }
+  switch (data[0]) {
+    case KEYMAP_HID_CONFIG_HIGHEST_LAYER:
+      value = zmk_keymap_highest_layer_active();
+      break;
+#if IS_ENABLED(CONFIG_ZMK_BLE)
+    case KEYMAP_HID_CONFIG_BLE_PROFILE:
+      value = zmk_ble_active_profile_index();
+      break;
+#endif
+#if IS_ENABLED(CONFIG_ZMK_USB_HOST_OS)
+    case KEYMAP_HID_CONFIG_USB_HOST_OS:
+      value = zmk_usb_host_os_detected();
+      break;
+#endif
+    default:
+      return KEYMAP_HID_STATUS_INVALID_ARG;
+  }
+  out[0] = data[0];
+  sys_put_le32(value, &out[1]);
+  *out_len = 5;
+  return KEYMAP_HID_STATUS_OK;
+}
+
+// runs on the system work queue, same as key position events.
+// so a batch of binding changes is never seen half applied.
+size_t zmk_keymap_hid_handle_message(const uint8_t *request, size_t len, uint8_t *response,
+                                     size_t response_size) {
+  size_t rp = 0;
+  size_t wp = 0;
+  // cmd(1) + len(1)
+  while (rp + 2 <= len && wp + RESPONSE_HEADER_BYTES <= response_size) {
+    uint8_t cmd = request[rp];
+    uint8_t data_len = request[rp + 1];
+    const uint8_t *data = &request[rp + 2];
+    uint8_t *out = &response[wp + RESPONSE_HEADER_BYTES];
+    size_t out_size = MIN(response_size - wp - RESPONSE_HEADER_BYTES, UINT8_MAX);
+    uint8_t out_len = 0;
+    uint8_t status;
+    rp += 2 + data_len;
+    if (rp > len) {
+      status = KEYMAP_HID_STATUS_INVALID_ARG;
+    } else {
+      switch (cmd) {
+        case KEYMAP_HID_CMD_GET_INFO:
+          status = get_info(data, data_len, out, &out_len, out_size);
+          break;
+        case KEYMAP_HID_CMD_GET_BINDINGS:
+          status = get_bindings(data, data_len, out, &out_len, out_size);
+          break;
+        case KEYMAP_HID_CMD_SET_BINDINGS:
+          status = set_bindings(data, data_len, out, &out_len, out_size);
+          break;
+        case KEYMAP_HID_CMD_GET_CONFIG:
+          status = get_config(data, data_len, out, &out_len, out_size);
+          break;
+        case KEYMAP_HID_CMD_SAVE_BINDINGS:
+          status = save_bindings(data, data_len, out, &out_len, out_size);
+          break;
+        case KEYMAP_HID_CMD_DISCARD_BINDINGS:
+          status = discard_bindings(data, data_len, out, &out_len, out_size);
+          break;
+        default:
+          status = KEYMAP_HID_STATUS_UNKNOWN_CMD;
+          break;
+      }
+    }
+    LOG_DBG("keymap hid: cmd:%d status:%d len:%d", cmd, status, out_len);
+    response[wp] = cmd;
+    response[wp + 1] = status;
+    response[wp + 2] = status == KEYMAP_HID_STATUS_OK ? out_len : 0;
+    wp += RESPONSE_HEADER_BYTES + response[wp + 2];
+  }
+  return wp;
+}
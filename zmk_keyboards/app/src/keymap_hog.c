@@ -60,6 +60,35 @@ static struct hids_report output = {
 static bool host_requests_notification = false;
 static uint8_t ctrl_point;
 
+enum {
+    STATE_PENDING,
+    STATE_PROCESSING,
+};
+
+static atomic_t state;
+static struct zmk_keymap_hid_assembler assembler;
+static struct zmk_keymap_hid_report_body last_report;
+
+struct hid_message {
+    uint8_t seq;
+    size_t len;
+    uint8_t buf[CONFIG_ZMK_KEYMAP_HID_MAX_MESSAGE_BYTES];
+};
+
+/*
+ * A completed request is copied to `request` and STATE_PENDING is set until it is handled, so
+ * chunks of the next request can be assembled meanwhile. STATE_PROCESSING is set while
+ * `response` is in use and is cleared by the HOG send work queue once every chunk of it has been
+ * handed to the stack, then a pending request is handled. A request is only rejected when
+ * another one is already pending.
+ */
+static struct hid_message request;
+static struct hid_message response;
+static struct zmk_keymap_hog_stats stats;
+
+static void process_request_callback(struct k_work *work);
+static K_WORK_DEFINE(process_work, process_request_callback);
+
 static ssize_t read_hids_info(struct bt_conn *conn, const struct bt_gatt_attr *attr, void *buf,
                               uint16_t len, uint16_t offset) {
     return bt_gatt_attr_read(conn, attr, buf, len, offset, attr->user_data,
@@ -80,9 +109,8 @@ static ssize_t read_hids_report_map(struct bt_conn *conn, const struct bt_gatt_a
 
 static ssize_t read_hids_input_report(struct bt_conn *conn, const struct bt_gatt_attr *attr,
                                       void *buf, uint16_t len, uint16_t offset) {
-    static const struct zmk_keymap_hid_sample_report_body report_body = {.data = {66}};
-    return bt_gatt_attr_read(conn, attr, buf, len, offset, &report_body,
-                             sizeof(struct zmk_keymap_hid_sample_report_body));
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, &last_report,
+                             KEYMAP_HID_CHUNK_HEADER_BYTES + last_report.len);
 }
 
 static ssize_t write_hids_output_report(struct bt_conn *conn, const struct bt_gatt_attr *attr,
@@ -92,18 +120,21 @@ static ssize_t write_hids_output_report(struct bt_conn *conn, const struct bt_ga
         LOG_ERR("Offset is wrong %d", offset);
         return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
     }
-    struct zmk_keymap_hid_sample_report_body *report;
-    if (len == sizeof(struct zmk_keymap_hid_sample_report_body)) {
-        report = (struct zmk_keymap_hid_sample_report_body *)buf;
-    } else if (len == sizeof(struct zmk_keymap_hid_sample_report)) {
-        struct zmk_keymap_hid_sample_report *wrapper = (struct zmk_keymap_hid_sample_report *)buf;
+    // chunks shorter than the report are allowed, trailing bytes are not sent
+    struct zmk_keymap_hid_report_body report = {0};
+    if (len == sizeof(struct zmk_keymap_hid_report)) {
+        const struct zmk_keymap_hid_report *wrapper = buf;
         if (wrapper->report_id != KEYMAP_HID_REPORT_ID) {
             return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
         }
-
-        report = &wrapper->body;
+        report = wrapper->body;
+    } else if (len >= KEYMAP_HID_CHUNK_HEADER_BYTES && len <= sizeof(report)) {
+        memcpy(&report, buf, len);
+        if (report.len > len - KEYMAP_HID_CHUNK_HEADER_BYTES) {
+            return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+        }
     } else {
-        LOG_ERR("Length is wrong %d vs %d", len, sizeof(struct zmk_keymap_hid_sample_report_body));
+        LOG_ERR("Length is wrong %d vs %d", len, sizeof(struct zmk_keymap_hid_report_body));
         return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
     }
 
@@ -113,7 +144,20 @@ static ssize_t write_hids_output_report(struct bt_conn *conn, const struct bt_ga
         return BT_GATT_ERR(BT_ATT_ERR_UNLIKELY);
     }
 
-    LOG_HEXDUMP_DBG(report->data, KEYMAP_HID_MAX_BYTES, "Got output data sent");
+    int ret = zmk_keymap_hid_assemble(&assembler, &report);
+    if (ret < 0) {
+        return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+    } else if (ret > 0) {
+        if (atomic_test_and_set_bit(&state, STATE_PENDING)) {
+            LOG_WRN("Previous keymap request is still pending");
+            stats.rejected++;
+            return BT_GATT_ERR(BT_ATT_ERR_INSUFFICIENT_RESOURCES);
+        }
+        request.seq = assembler.seq;
+        request.len = assembler.len;
+        memcpy(request.buf, assembler.buf, assembler.len);
+        k_work_submit(&process_work);
+    }
 
     return len;
 }
@@ -180,77 +224,80 @@ static K_THREAD_STACK_DEFINE(hog_q_stack, CONFIG_ZMK_BLE_THREAD_STACK_SIZE);
 
 static struct k_work_q hog_work_q;
 
-K_MSGQ_DEFINE(zmk_hog_keymap_msgq, sizeof(struct zmk_hid_keyboard_report_body),
-              CONFIG_ZMK_BLE_KEYBOARD_REPORT_QUEUE_SIZE, 4);
-
-static void send_keymap_report_callback(struct k_work *work) {
-    struct zmk_keymap_hid_sample_report_body report;
-
-    while (k_msgq_get(&zmk_hog_keymap_msgq, &report, K_NO_WAIT) == 0) {
-        struct bt_conn *conn = destination_connection();
-        if (conn == NULL) {
-            return;
-        }
+// payload bytes of a notification for the current ATT MTU
+static size_t chunk_payload_size(struct bt_conn *conn) {
+    // ATT notification header is 3 bytes
+    size_t size = MIN(KEYMAP_HID_MAX_BYTES, bt_gatt_get_mtu(conn) - 3);
+    return size - KEYMAP_HID_CHUNK_HEADER_BYTES;
+}
 
+static void send_response(const struct hid_message *message) {
+    struct bt_conn *conn = destination_connection();
+    if (conn == NULL) {
+        stats.dropped++;
+        return;
+    }
+    size_t max_payload = chunk_payload_size(conn);
+    size_t offset = 0;
+    do {
+        offset += zmk_keymap_hid_fill_chunk(&last_report, message->seq, message->buf,
+                                            message->len, offset, max_payload);
         struct bt_gatt_notify_params notify_params = {
             .attr = &keymap_hog_svc.attrs[5],
-            .data = &report,
-            .len = sizeof(report),
+            .data = &last_report,
+            .len = KEYMAP_HID_CHUNK_HEADER_BYTES + last_report.len,
         };
 
         int err = bt_gatt_notify_cb(conn, &notify_params);
         if (err == -EPERM) {
             bt_conn_set_security(conn, BT_SECURITY_L2);
-        } else if (err) {
+        }
+        if (err) {
             LOG_DBG("Error notifying %d", err);
+            // rest of the message is useless to the host
+            stats.dropped++;
+            break;
         }
+        stats.sent++;
+    } while (offset < message->len);
+
+    bt_conn_unref(conn);
+}
 
-        bt_conn_unref(conn);
+static void send_keymap_report_callback(struct k_work *work) {
+    send_response(&response);
+    atomic_clear_bit(&state, STATE_PROCESSING);
+    if (atomic_test_bit(&state, STATE_PENDING)) {
+        k_work_submit(&process_work);
     }
 }
 
 static K_WORK_DEFINE(hog_keyboard_work, send_keymap_report_callback);
 
-int zmk_hog_send_keymap_report(struct zmk_keymap_hid_sample_report_body *report) {
-    int err = k_msgq_put(&zmk_hog_keymap_msgq, report, K_MSEC(100));
-    if (err) {
-        switch (err) {
-        case -EAGAIN: {
-            LOG_WRN("Keyboard message queue full, popping first message and queueing again");
-            struct zmk_keymap_hid_sample_report_body discarded_report;
-            k_msgq_get(&zmk_hog_keymap_msgq, &discarded_report, K_NO_WAIT);
-            return zmk_hog_send_keymap_report(report);
-        }
-        default:
-            LOG_WRN("Failed to queue keymap report to send (%d)", err);
-            return err;
-        }
+static void process_request_callback(struct k_work *work) {
+    if (!atomic_test_bit(&state, STATE_PENDING)) {
+        return;
     }
-
+    if (atomic_test_and_set_bit(&state, STATE_PROCESSING)) {
+        // resubmitted once the previous response has been sent
+        return;
+    }
+    response.seq = request.seq;
+    response.len = zmk_keymap_hid_handle_message(request.buf, request.len, response.buf,
+                                                 sizeof(response.buf));
+    atomic_clear_bit(&state, STATE_PENDING);
+    stats.queued++;
+    // STATE_PROCESSING stays set until the response has been sent
     k_work_submit_to_queue(&hog_work_q, &hog_keyboard_work);
-
-    return 0;
-};
-
-static void send_work_cb(struct k_work *_work) {
-    struct zmk_keymap_hid_sample_report_body body = {.data = {42}};
-
-    zmk_hog_send_keymap_report(&body);
 }
 
-static K_WORK_DEFINE(send_work, send_work_cb);
-
-static void tick_cb() { k_work_submit(&send_work); }
-
-static K_TIMER_DEFINE(send_timer, tick_cb, NULL);
+struct zmk_keymap_hog_stats zmk_keymap_hid_hog_get_stats(void) { return stats; }
 
 static int zmk_keymap_hog_init(void) {
     static const struct k_work_queue_config queue_config = {.name =
                                                                 "Keymap HID Over GATT Send Work"};
     k_work_queue_start(&hog_work_q, hog_q_stack, K_THREAD_STACK_SIZEOF(hog_q_stack),
                        CONFIG_ZMK_BLE_THREAD_PRIORITY, &queue_config);
-
-    k_timer_start(&send_timer, K_SECONDS(1), K_SECONDS(1));
     return 0;
 }
 
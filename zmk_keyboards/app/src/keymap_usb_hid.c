@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <string.h>
 #include <zephyr/device.h>
 #include <zephyr/init.h>
 
@@ -15,46 +16,157 @@
 #include <zmk/keymap_hid.h>
 #include <zmk/keymap.h>
 #include <zmk/event_manager.h>
+#include <zmk/events/usb_conn_state_changed.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 static const struct device *hid_dev;
 
-static K_SEM_DEFINE(hid_sem, 1, 1);
+// a response that can't be queued by then is dropped, the host has to resend the request
+#define RESPONSE_TIMEOUT_MS 1000
+
+// reports waiting for the IN endpoint, drained from in_ready_cb()
+static struct zmk_keymap_hid_report queue[CONFIG_ZMK_KEYMAP_USB_HID_QUEUE_SIZE];
+static uint8_t queue_head;
+static uint8_t queue_count;
+// an armed transfer stays armed until the host polls it, or until a bus reset, disconnect
+// or reconfiguration which flushes the queue through usb_conn_listener()
+static bool in_flight;
+static struct k_spinlock queue_lock;
+static struct zmk_keymap_usb_hid_stats stats;
+
+// endpoint write may block on the driver, queue_lock is only held to pop the report
+static void write_next_report(void) {
+    for (;;) {
+        struct zmk_keymap_hid_report report;
+        k_spinlock_key_t key = k_spin_lock(&queue_lock);
+        if (in_flight || !queue_count) {
+            k_spin_unlock(&queue_lock, key);
+            return;
+        }
+        report = queue[queue_head];
+        queue_head = (queue_head + 1) % CONFIG_ZMK_KEYMAP_USB_HID_QUEUE_SIZE;
+        queue_count--;
+        in_flight = true;
+        k_spin_unlock(&queue_lock, key);
+
+        uint32_t written;
+        int err = hid_int_ep_write(hid_dev, (uint8_t *)&report, sizeof(report), &written);
+
+        key = k_spin_lock(&queue_lock);
+        if (err) {
+            in_flight = false;
+            stats.failed++;
+        } else {
+            stats.sent++;
+        }
+        k_spin_unlock(&queue_lock, key);
+        if (!err) {
+            return;
+        }
+        LOG_WRN("Failed to write keymap report (%d)", err);
+    }
+}
+
+static void flush_queue(void) {
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+    queue_count = 0;
+    in_flight = false;
+    k_spin_unlock(&queue_lock, key);
+}
 
 static void in_ready_cb(const struct device *dev) {
-    LOG_DBG("");
-    k_sem_give(&hid_sem);
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+    in_flight = false;
+    k_spin_unlock(&queue_lock, key);
+    write_next_report();
+}
+
+static struct zmk_keymap_hid_assembler assembler;
+static uint8_t response[CONFIG_ZMK_KEYMAP_HID_MAX_MESSAGE_BYTES];
+static atomic_t processing;
+static struct zmk_keymap_hid_report last_report = {.report_id = KEYMAP_HID_REPORT_ID};
+
+static size_t response_len;
+static size_t response_offset;
+static int64_t response_deadline;
+
+static void send_response_callback(struct k_work *work) {
+    struct zmk_keymap_hid_report report = {.report_id = KEYMAP_HID_REPORT_ID};
+    do {
+        size_t size = zmk_keymap_hid_fill_chunk(&report.body, assembler.seq, response, response_len,
+                                                response_offset, KEYMAP_HID_CHUNK_MAX_PAYLOAD);
+        int err = zmk_keymap_hid_usb_hid_send_report((uint8_t *)&report, sizeof(report));
+        if (err == -EAGAIN && k_uptime_get() < response_deadline) {
+            // retry after the endpoint drained the queue
+            k_work_schedule(k_work_delayable_from_work(work), K_MSEC(1));
+            return;
+        } else if (err) {
+            LOG_WRN("Failed to send keymap response (%d)", err);
+            k_spinlock_key_t key = k_spin_lock(&queue_lock);
+            stats.dropped++;
+            k_spin_unlock(&queue_lock, key);
+            break;
+        }
+        last_report = report;
+        response_offset += size;
+    } while (response_offset < response_len);
+    atomic_clear(&processing);
+}
+
+static K_WORK_DELAYABLE_DEFINE(send_response_work, send_response_callback);
+
+static void process_request_callback(struct k_work *work) {
+    response_len = zmk_keymap_hid_handle_message(assembler.buf, assembler.len, response,
+                                                 sizeof(response));
+    response_offset = 0;
+    response_deadline = k_uptime_get() + RESPONSE_TIMEOUT_MS;
+    k_work_schedule(&send_response_work, K_NO_WAIT);
+}
+
+static K_WORK_DEFINE(process_work, process_request_callback);
+
+// data starts with report id
+static void receive_report(const uint8_t *data, size_t len) {
+    struct zmk_keymap_hid_report report = {0};
+    if (len < 1 + KEYMAP_HID_CHUNK_HEADER_BYTES || len > sizeof(report) ||
+        data[0] != KEYMAP_HID_REPORT_ID) {
+        LOG_WRN("Unexpected keymap report, len: %d", len);
+        return;
+    }
+    if (atomic_get(&processing)) {
+        LOG_WRN("Previous keymap request is still in process");
+        return;
+    }
+    memcpy(&report, data, len);
+    if (zmk_keymap_hid_assemble(&assembler, &report.body) > 0) {
+        atomic_set(&processing, 1);
+        k_work_submit(&process_work);
+    }
 }
 
 #ifdef CONFIG_ENABLE_HID_INT_OUT_EP
 static void out_ready_cb(const struct device *dev) {
-    LOG_DBG("");
-    uint8_t data[20];
+    uint8_t data[sizeof(struct zmk_keymap_hid_report)];
     uint32_t read;
 
-    hid_int_ep_read(dev, data, 20, &read);
-
-    if (read > 0) {
-        LOG_DBG("Got %d bytes", read);
-        LOG_HEXDUMP_DBG(data, read, "Got data");
+    if (hid_int_ep_read(dev, data, sizeof(data), &read) == 0 && read > 0) {
+        receive_report(data, read);
     }
 }
 #endif
 
-static uint8_t payload[] = {0x42, 0x02};
-
 static int get_report_cb(const struct device *dev, struct usb_setup_packet *setup, int32_t *len,
                          uint8_t **data) {
-    LOG_DBG("");
-    *data = payload;
-    *len = sizeof(payload);
+    *data = (uint8_t *)&last_report;
+    *len = sizeof(last_report);
     return 0;
 }
 
 static int set_report_cb(const struct device *dev, struct usb_setup_packet *setup, int32_t *len,
                          uint8_t **data) {
-    LOG_HEXDUMP_DBG(*data, *len, "REPORT SET");
+    // hosts without the OUT endpoint use SET_REPORT(Output)
+    receive_report(*data, *len);
     return 0;
 }
 
@@ -67,6 +179,9 @@ static const struct hid_ops ops = {.get_report = get_report_cb,
 };
 
 int zmk_keymap_hid_usb_hid_send_report(const uint8_t *report, size_t len) {
+    if (len > sizeof(struct zmk_keymap_hid_report)) {
+        return -EINVAL;
+    }
     switch (zmk_usb_get_status()) {
     case USB_DC_SUSPEND:
         return usb_wakeup_request();
@@ -74,31 +189,63 @@ int zmk_keymap_hid_usb_hid_send_report(const uint8_t *report, size_t len) {
     case USB_DC_RESET:
     case USB_DC_DISCONNECTED:
     case USB_DC_UNKNOWN:
+        // pending transfer never completes
+        flush_queue();
         return -ENODEV;
     default:
-        k_sem_take(&hid_sem, K_MSEC(30));
-        uint32_t written;
-        int err = hid_int_ep_write(hid_dev, report, len, &written);
-
-        if (err) {
-            k_sem_give(&hid_sem);
-        }
+        break;
+    }
 
-        return err;
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+    if (queue_count == CONFIG_ZMK_KEYMAP_USB_HID_QUEUE_SIZE) {
+        stats.busy++;
+        k_spin_unlock(&queue_lock, key);
+        return -EAGAIN;
     }
+    struct zmk_keymap_hid_report *slot =
+        &queue[(queue_head + queue_count) % CONFIG_ZMK_KEYMAP_USB_HID_QUEUE_SIZE];
+    memcpy(slot, report, len);
+    memset((uint8_t *)slot + len, 0, sizeof(struct zmk_keymap_hid_report) - len);
+    queue_count++;
+    stats.queued++;
+    stats.max_depth = MAX(stats.max_depth, queue_count);
+    k_spin_unlock(&queue_lock, key);
+    write_next_report();
+    return 0;
 }
 
-static void send_work_cb(struct k_work *_work) {
-    uint8_t data[] = {KEYMAP_HID_REPORT_ID, 42};
-
-    zmk_keymap_hid_usb_hid_send_report(data, sizeof(data));
+struct zmk_keymap_usb_hid_stats zmk_keymap_hid_usb_hid_get_stats(void) {
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+    struct zmk_keymap_usb_hid_stats copy = stats;
+    k_spin_unlock(&queue_lock, key);
+    return copy;
 }
 
-K_WORK_DEFINE(send_work, send_work_cb);
-
-static void tick_cb() { k_work_submit(&send_work); }
+// bus reset, disconnect or a new configuration ends the transfer in progress without
+// in_ready_cb()
+static int usb_conn_listener(const zmk_event_t *eh) {
+    switch (zmk_usb_get_status()) {
+    case USB_DC_ERROR:
+    case USB_DC_RESET:
+    case USB_DC_DISCONNECTED:
+    case USB_DC_UNKNOWN:
+    case USB_DC_CONFIGURED:
+        flush_queue();
+        // response in progress is for a host that is gone, a request still being handled
+        // finds the bus down and gives up by itself.
+        k_work_cancel_delayable(&send_response_work);
+        if (!k_work_is_pending(&process_work)) {
+            atomic_clear(&processing);
+        }
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
 
-K_TIMER_DEFINE(send_timer, tick_cb, NULL);
+ZMK_LISTENER(keymap_usb_hid, usb_conn_listener);
+ZMK_SUBSCRIPTION(keymap_usb_hid, zmk_usb_conn_state_changed);
 
 static int zmk_keymap_hid_usb_init(void) {
     int ret;
@@ -118,8 +265,6 @@ static int zmk_keymap_hid_usb_init(void) {
         return ret;
     }
 
-    k_timer_start(&send_timer, K_SECONDS(1), K_SECONDS(1));
-
     return 0;
 }
 
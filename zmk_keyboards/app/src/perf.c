@@ -0,0 +1,141 @@
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <zmk/endpoints.h>
+#include <zmk/endpoints_types.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/keycode_state_changed.h>
+#include <zmk/events/layer_state_changed.h>
+#include <zmk/events/position_state_changed.h>
+#include <zmk/perf.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+static struct k_spinlock lock;
+static struct zmk_perf_stats stats;
+
+static uint32_t begin_cycles[ZMK_PERF_EVENT_COUNT];
+// position event being dispatched, keycode events raised inside of it share its timestamp
+static int64_t position_timestamp = -1;
+
+static uint8_t latency_bucket(uint32_t us) {
+  if (us < ZMK_PERF_LATENCY_SUB_BUCKETS) {
+    return us;
+  }
+  uint8_t msb = 31 - __builtin_clz(us);
+  uint32_t index = (msb - 1) * ZMK_PERF_LATENCY_SUB_BUCKETS + ((us >> (msb - 2)) & 3);
+  return MIN(index, ZMK_PERF_LATENCY_BUCKETS - 1);
+}
+
+static uint32_t latency_bucket_upper_us(uint8_t index) {
+  if (index < ZMK_PERF_LATENCY_SUB_BUCKETS) {
+    return index;
+  }
+  uint8_t msb = index / ZMK_PERF_LATENCY_SUB_BUCKETS + 1;
+  uint32_t lower = (ZMK_PERF_LATENCY_SUB_BUCKETS + index % ZMK_PERF_LATENCY_SUB_BUCKETS)
+                   << (msb - 2);
+  return lower + BIT(msb - 2) - 1;
+}
+
+static enum zmk_perf_event event_type(const zmk_event_t *eh) {
+  if (as_zmk_position_state_changed(eh) != NULL) {
+    return ZMK_PERF_EVENT_POSITION;
+  }
+  if (as_zmk_keycode_state_changed(eh) != NULL) {
+    return ZMK_PERF_EVENT_KEYCODE;
+  }
+  return ZMK_PERF_EVENT_LAYER;
+}
+
+static int perf_begin_listener(const zmk_event_t *eh) {
+  enum zmk_perf_event type = event_type(eh);
+  begin_cycles[type] = k_cycle_get_32();
+  if (type == ZMK_PERF_EVENT_POSITION) {
+    const struct zmk_position_state_changed *ev = as_zmk_position_state_changed(eh);
+    uint32_t delay_ms = k_uptime_get() - ev->timestamp;
+    position_timestamp = ev->timestamp;
+    K_SPINLOCK(&lock) {
+      stats.kscan_events++;
+      stats.kscan_delay_max_ms = MAX(stats.kscan_delay_max_ms, delay_ms);
+    }
+  }
+  return ZMK_EV_EVENT_BUBBLE;
+}
+
+static int perf_end_listener(const zmk_event_t *eh) {
+  uint32_t now = k_cycle_get_32();
+  enum zmk_perf_event type = event_type(eh);
+  uint32_t dispatch_us = k_cyc_to_us_floor32(now - begin_cycles[type]);
+  const struct zmk_keycode_state_changed *keycode = as_zmk_keycode_state_changed(eh);
+  uint32_t latency_us = 0;
+  if (type == ZMK_PERF_EVENT_POSITION) {
+    // a keycode raised later (hold-tap timeout) must not match this position event
+    position_timestamp = -1;
+  } else if (keycode != NULL) {
+    // hid listener has sent the report by now. keycodes deferred by a behavior (hold-tap,
+    // tap-dance) fall back to the millisecond kscan timestamp.
+    latency_us = keycode->timestamp == position_timestamp
+                   ? k_cyc_to_us_floor32(now - begin_cycles[ZMK_PERF_EVENT_POSITION])
+                   : (uint32_t)(k_uptime_get() - keycode->timestamp) * USEC_PER_MSEC;
+  }
+  K_SPINLOCK(&lock) {
+    struct zmk_perf_dispatch_stats *dispatch = &stats.dispatch[type];
+    dispatch->count++;
+    dispatch->total_us += dispatch_us;
+    dispatch->max_us = MAX(dispatch->max_us, dispatch_us);
+    if (keycode != NULL) {
+      if (zmk_endpoints_selected().transport == ZMK_TRANSPORT_USB) {
+        stats.usb_keycodes++;
+      } else {
+        stats.ble_keycodes++;
+      }
+      stats.latency[latency_bucket(latency_us)]++;
+      stats.latency_max_us = MAX(stats.latency_max_us, latency_us);
+    }
+  }
+  return ZMK_EV_EVENT_BUBBLE;
+}
+
+// subscriptions are dispatched in the order of their names, so these two bracket every other
+// listener of the same event. an event captured by a behavior never reaches the end listener.
+ZMK_LISTENER(_perf_begin, perf_begin_listener);
+ZMK_SUBSCRIPTION(_perf_begin, zmk_position_state_changed);
+ZMK_SUBSCRIPTION(_perf_begin, zmk_keycode_state_changed);
+ZMK_SUBSCRIPTION(_perf_begin, zmk_layer_state_changed);
+
+ZMK_LISTENER(zz_perf_end, perf_end_listener);
+ZMK_SUBSCRIPTION(zz_perf_end, zmk_position_state_changed);
+ZMK_SUBSCRIPTION(zz_perf_end, zmk_keycode_state_changed);
+ZMK_SUBSCRIPTION(zz_perf_end, zmk_layer_state_changed);
+
+void zmk_perf_snapshot(struct zmk_perf_stats *snapshot) {
+  K_SPINLOCK(&lock) { *snapshot = stats; }
+}
+
+void zmk_perf_reset(void) {
+  K_SPINLOCK(&lock) {
+    memset(&stats, 0, sizeof(stats));
+    stats.since_ms = k_uptime_get();
+  }
+}
+
+uint32_t zmk_perf_latency_percentile_us(const struct zmk_perf_stats *snapshot, uint8_t percent) {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < ZMK_PERF_LATENCY_BUCKETS; i++) {
+    total += snapshot->latency[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+  // rank of the sample, rounded up
+  uint32_t rank = DIV_ROUND_UP(total * percent, 100);
+  uint32_t count = 0;
+  for (uint8_t i = 0; i < ZMK_PERF_LATENCY_BUCKETS; i++) {
+    count += snapshot->latency[i];
+    if (count >= MAX(rank, 1)) {
+      return MIN(latency_bucket_upper_us(i), snapshot->latency_max_us);
+    }
+  }
+  return snapshot->latency_max_us;
+}
@@ -0,0 +1,34 @@
+#include <zephyr/kernel.h>
+
+#include <zmk/endpoints.h>
+#include <zmk/report_interval.h>
+#if IS_ENABLED(CONFIG_ZMK_BLE)
+#  include <zephyr/bluetooth/conn.h>
+#  include <zmk/ble.h>
+#endif
+
+int zmk_report_interval_ms(void) {
+  switch (zmk_endpoints_selected().transport) {
+#if IS_ENABLED(CONFIG_ZMK_USB)
+    case ZMK_TRANSPORT_USB:
+      return CONFIG_USB_HID_POLL_INTERVAL_MS;
+#endif
+#if IS_ENABLED(CONFIG_ZMK_BLE)
+    case ZMK_TRANSPORT_BLE: {
+      struct bt_conn *conn = zmk_ble_active_profile_conn();
+      struct bt_conn_info info;
+      int interval = 0;
+      if (conn != NULL) {
+        if (bt_conn_get_info(conn, &info) == 0) {
+          // 1.25ms units
+          interval = info.le.interval * 5 / 4;
+        }
+        bt_conn_unref(conn);
+      }
+      return interval;
+    }
+#endif
+    default:
+      return 0;
+  }
+}
@@ -4,6 +4,12 @@
 #  include <zephyr/usb/usb_device.h>
 #  include <zmk/usb_host_os.h>
 #endif  // CONFIG_ZMK_USB_HOST_OS_DEBUG
+#if IS_ENABLED(CONFIG_ZMK_RAW_HID_TEST)
+#  include <zmk/keymap_hid.h>
+#endif  // CONFIG_ZMK_RAW_HID_TEST
+#if IS_ENABLED(CONFIG_ZMK_PERF)
+#  include <zmk/perf.h>
+#endif  // CONFIG_ZMK_PERF
 
 static int cmd_hello(const struct shell *sh, size_t argc, char **argv) {
   shell_fprintf(sh, SHELL_NORMAL, "hello!\n");
@@ -209,11 +215,80 @@ static int cmd_usb_setup_log(const struct shell *sh, size_t argc, char **argv) {
 }
 #endif  // CONFIG_ZMK_USB_HOST_OS_DEBUG
 
+#if IS_ENABLED(CONFIG_ZMK_RAW_HID_TEST)
+static int cmd_keymap_hid_stats(const struct shell *sh, size_t argc, char **argv) {
+  struct zmk_keymap_usb_hid_stats usb = zmk_keymap_hid_usb_hid_get_stats();
+  shell_fprintf(sh, SHELL_NORMAL,
+                "usb: queued:%u sent:%u busy:%u dropped:%u failed:%u max_depth:%u\n", usb.queued,
+                usb.sent, usb.busy, usb.dropped, usb.failed, usb.max_depth);
+#  if IS_ENABLED(CONFIG_ZMK_BLE)
+  struct zmk_keymap_hog_stats hog = zmk_keymap_hid_hog_get_stats();
+  shell_fprintf(sh, SHELL_NORMAL, "hog: queued:%u rejected:%u sent:%u dropped:%u\n", hog.queued,
+                hog.rejected, hog.sent, hog.dropped);
+#  endif
+  return 0;
+}
+#endif  // CONFIG_ZMK_RAW_HID_TEST
+
+#if IS_ENABLED(CONFIG_ZMK_PERF)
+static const char *const event_names[ZMK_PERF_EVENT_COUNT] = {"position", "keycode", "layer"};
+
+static int cmd_perf_snapshot(const struct shell *sh, size_t argc, char **argv) {
+  struct zmk_perf_stats stats;
+  zmk_perf_snapshot(&stats);
+  uint32_t elapsed_ms = MAX(k_uptime_get() - stats.since_ms, 1);
+  shell_fprintf(sh, SHELL_NORMAL, "window: %u ms\n", elapsed_ms);
+  shell_fprintf(sh, SHELL_NORMAL, "kscan: events:%u rate:%u/min delay_max:%u ms\n",
+                stats.kscan_events, (uint32_t)((uint64_t)stats.kscan_events * 60000 / elapsed_ms),
+                stats.kscan_delay_max_ms);
+  for (uint8_t i = 0; i < ZMK_PERF_EVENT_COUNT; i++) {
+    const struct zmk_perf_dispatch_stats *dispatch = &stats.dispatch[i];
+    shell_fprintf(sh, SHELL_NORMAL, "dispatch %s: count:%u avg:%u us max:%u us\n", event_names[i],
+                  dispatch->count, dispatch->count ? dispatch->total_us / dispatch->count : 0,
+                  dispatch->max_us);
+  }
+  shell_fprintf(sh, SHELL_NORMAL, "latency: p50:%u p90:%u p99:%u max:%u us\n",
+                zmk_perf_latency_percentile_us(&stats, 50),
+                zmk_perf_latency_percentile_us(&stats, 90),
+                zmk_perf_latency_percentile_us(&stats, 99), stats.latency_max_us);
+  shell_fprintf(sh, SHELL_NORMAL, "keycodes: usb:%u ble:%u\n", stats.usb_keycodes,
+                stats.ble_keycodes);
+#  if IS_ENABLED(CONFIG_ZMK_RAW_HID_TEST)
+  struct zmk_keymap_usb_hid_stats usb = zmk_keymap_hid_usb_hid_get_stats();
+  shell_fprintf(sh, SHELL_NORMAL, "queue keymap usb: max_depth:%u/%u\n", usb.max_depth,
+                CONFIG_ZMK_KEYMAP_USB_HID_QUEUE_SIZE);
+#  endif
+  return 0;
+}
+
+static int cmd_perf_reset(const struct shell *sh, size_t argc, char **argv) {
+  zmk_perf_reset();
+  shell_fprintf(sh, SHELL_NORMAL, "perf counters reset\n");
+  return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_perf,
+                               SHELL_CMD_ARG(snapshot, NULL, "show timing since last reset",
+                                             cmd_perf_snapshot, 1, 0),
+                               SHELL_CMD_ARG(reset, NULL, "reset timing counters", cmd_perf_reset,
+                                             1, 0),
+                               SHELL_SUBCMD_SET_END /* Array terminated. */
+);
+#endif  // CONFIG_ZMK_PERF
+
 SHELL_STATIC_SUBCMD_SET_CREATE(sub_zmk, SHELL_CMD_ARG(hello, NULL, "Hello", cmd_hello, 1, 0),
 #if IS_ENABLED(CONFIG_ZMK_USB_HOST_OS_DEBUG)
                                SHELL_CMD_ARG(usb_setup_log, NULL, "show usb HID class setup log",
                                              cmd_usb_setup_log, 1, 0),
 #endif  // CONFIG_ZMK_USB_HOST_OS_DEBUG
+#if IS_ENABLED(CONFIG_ZMK_RAW_HID_TEST)
+                               SHELL_CMD_ARG(keymap_hid_stats, NULL, "keymap HID counters",
+                                             cmd_keymap_hid_stats, 1, 0),
+#endif  // CONFIG_ZMK_RAW_HID_TEST
+#if IS_ENABLED(CONFIG_ZMK_PERF)
+                               SHELL_CMD(perf, &sub_perf, "scan, event and HID report timing",
+                                         NULL),
+#endif  // CONFIG_ZMK_PERF
 
                                SHELL_SUBCMD_SET_END /* Array terminated. */
 );
@@ -4,8 +4,9 @@
 #include <zmk/event_manager.h>
 #include <zmk/events/usb_host_os_changed.h>
 #include <zmk/events/usb_conn_state_changed.h>
-#include "zephyr/usb/class/hid.h"
 
+// after the last packet. a prefix of a signature is never settled on earlier, macOS 14 sends
+// feature report 9 well after its LED reports.
 #define USB_HID_SETUP_TIMEOUT_MS 1000
 
 #if IS_ENABLED(CONFIG_ZMK_USB_HOST_OS_DEBUG)
@@ -17,10 +18,11 @@ static int packet_cnt;
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 static enum usb_host_os detected_os = USB_HOST_OS_UNDEFINED;
+static struct zmk_usb_host_os_matcher matcher;
 
 static void end_usb_hid_setup(struct k_work *work) {
   if (detected_os == USB_HOST_OS_UNDEFINED) {
-    detected_os = USB_HOST_OS_UNKNOWN;
+    detected_os = zmk_usb_host_os_match_completed(&matcher);
   }
   LOG_DBG("os detection end, packet_cnt: %d, detected_os:%d", packet_cnt, detected_os);
   raise_zmk_usb_host_os_changed((struct zmk_usb_host_os_changed){.os = zmk_usb_host_os_detected()});
@@ -35,19 +37,17 @@ void zmk_usb_host_os_trace_hid_setup(struct usb_setup_packet *setup) {
   }
 #endif
   packet_cnt++;
-  if (detected_os == USB_HOST_OS_UNDEFINED) {
-    // only work when CONFIG_USB_DEVICE_VID=0x05AC and CONFIG_USB_DEVICE_PID = 0x024F
-    //
-    //   bRequest: '9:HID_SET_REPORT'
-    //   reportType: '3:FEATURE_REPORT'
-    //   reportId : 9
-    //
-    // TODO not tested on iOS
-    //
-    LOG_DBG("usb_host_os: bRequest: %d, wValue: %0x", setup->bRequest, setup->wValue);
-    if (setup->bRequest == USB_HID_SET_REPORT && setup->wValue == 0x0309) {
-      detected_os = USB_HOST_OS_DARWIN;
-    }
+  if (detected_os != USB_HOST_OS_UNDEFINED) {
+    return;
+  }
+  LOG_DBG("usb_host_os: bRequest: %d, wValue: %0x, wLength: %d", setup->bRequest, setup->wValue,
+          setup->wLength);
+  enum usb_host_os os = zmk_usb_host_os_match(&matcher, setup);
+  if (os != USB_HOST_OS_UNDEFINED) {
+    // certain, raise the event from the system work queue right now
+    detected_os = os;
+    k_work_reschedule(&usb_host_os_work, K_NO_WAIT);
+  } else {
     k_work_reschedule(&usb_host_os_work, K_MSEC(USB_HID_SETUP_TIMEOUT_MS));
   }
 }
@@ -70,6 +70,7 @@ static int usb_conn_listener(const zmk_event_t *eh) {
   LOG_DBG("os detection start");
   packet_cnt = 0;
   detected_os = USB_HOST_OS_UNDEFINED;
+  zmk_usb_host_os_match_reset(&matcher);
   k_work_reschedule(&usb_host_os_work, K_MSEC(USB_HID_SETUP_TIMEOUT_MS));
   // }
   return 0;
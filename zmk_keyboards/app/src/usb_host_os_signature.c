@@ -0,0 +1,100 @@
+#include <string.h>
+#include <zephyr/sys/util.h>
+
+#include <zmk/usb_host_os.h>
+#include "zephyr/usb/class/hid.h"
+
+#define ANY 0xffff
+#define SIGNATURE_PACKETS_MAX 4
+
+// HID class requests seen by get_report_cb/set_report_cb.
+// repeated packets are folded into one step.
+//
+// see resources/usb_hid_class_setup_log.js, resources/zmk_usb_setup_log.js
+struct usb_hid_setup_signature {
+  enum usb_host_os os;
+  uint8_t len;
+  struct {
+    uint8_t bRequest;
+    uint16_t wValue;
+    uint16_t wLength;
+  } packets[SIGNATURE_PACKETS_MAX];
+};
+
+static const struct usb_hid_setup_signature signatures[] = {
+  // darwin only works when CONFIG_USB_DEVICE_VID=0x05AC and CONFIG_USB_DEVICE_PID = 0x024F
+  //
+  // macOS 13, feature report 9 only
+  {USB_HOST_OS_DARWIN, 1, {{USB_HID_SET_REPORT, 0x0309, 3}}},
+  // macOS 14, LED output reports, then feature report 9
+  {USB_HOST_OS_DARWIN, 2, {{USB_HID_SET_REPORT, 0x0201, ANY}, {USB_HID_SET_REPORT, 0x0309, 3}}},
+  // no windows signature: Windows 11 only sends the LED output report, as Linux, ChromeOS and
+  // Android do, and it is also the start of macOS 14. windows needs a request no other host sends.
+  // TODO not tested on iOS
+};
+
+#define SIGNATURES_LEN ARRAY_SIZE(signatures)
+
+BUILD_ASSERT(SIGNATURES_LEN <= 32, "too many usb hid setup signatures");
+
+static bool match_packet(const struct usb_hid_setup_signature *signature, uint8_t step,
+                         const struct usb_setup_packet *setup) {
+  if (step >= signature->len) {
+    return false;
+  }
+  const typeof(signature->packets[0]) *packet = &signature->packets[step];
+  return packet->bRequest == setup->bRequest && packet->wValue == setup->wValue &&
+         (packet->wLength == ANY || packet->wLength == setup->wLength);
+}
+
+// narrow the candidates, returns the os when a signature completed and all candidates agree.
+// a prefix alone decides nothing, other hosts may send the same requests.
+static enum usb_host_os classify(struct zmk_usb_host_os_matcher *matcher,
+                                 const struct usb_setup_packet *setup) {
+  enum usb_host_os os = USB_HOST_OS_UNDEFINED;
+  bool completed = false;
+  for (int i = 0; i < SIGNATURES_LEN; i++) {
+    if (matcher->rejected & BIT(i)) {
+      continue;
+    }
+    if (!match_packet(&signatures[i], matcher->step, setup)) {
+      matcher->rejected |= BIT(i);
+      continue;
+    }
+    if (signatures[i].len == matcher->step + 1) {
+      matcher->completed_os = signatures[i].os;
+      completed = true;
+    }
+    if (os == USB_HOST_OS_UNDEFINED) {
+      os = signatures[i].os;
+    } else if (os != signatures[i].os) {
+      os = USB_HOST_OS_UNKNOWN;
+    }
+  }
+  matcher->step++;
+  if (matcher->rejected == BIT_MASK(SIGNATURES_LEN)) {
+    // no signature left, nothing to wait for
+    return zmk_usb_host_os_match_completed(matcher);
+  }
+  return completed && os != USB_HOST_OS_UNKNOWN ? os : USB_HOST_OS_UNDEFINED;
+}
+
+void zmk_usb_host_os_match_reset(struct zmk_usb_host_os_matcher *matcher) {
+  memset(matcher, 0, sizeof(*matcher));
+}
+
+enum usb_host_os zmk_usb_host_os_match(struct zmk_usb_host_os_matcher *matcher,
+                                       const struct usb_setup_packet *setup) {
+  if (matcher->step > 0 && setup->bRequest == matcher->last_bRequest &&
+      setup->wValue == matcher->last_wValue) {
+    return USB_HOST_OS_UNDEFINED;
+  }
+  matcher->last_bRequest = setup->bRequest;
+  matcher->last_wValue = setup->wValue;
+  return classify(matcher, setup);
+}
+
+enum usb_host_os zmk_usb_host_os_match_completed(const struct zmk_usb_host_os_matcher *matcher) {
+  return matcher->completed_os != USB_HOST_OS_UNDEFINED ? matcher->completed_os
+                                                        : USB_HOST_OS_UNKNOWN;
+}
@@ -30,79 +30,70 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #endif
 
 #define BEEP_DURATION K_MSEC(60)
+#define BEEP_INTERVAL K_MSEC(50)
 
 static const struct pwm_dt_spec pwm = PWM_DT_SPEC_GET(BUZZER_NODE);
 
-static void _play(uint32_t period) {
-    if (!device_is_ready(pwm.dev)) {
-        printk("Error: PWM device %s is not ready\n", pwm.dev->name);
-        return;
-    }
-    pwm_set_dt(&pwm, period, period / 2U); // attempt at new implementation
-    k_sleep(BEEP_DURATION);
-    pwm_set_dt(&pwm, 0, 0); // attempt at new implementation
-    k_sleep(K_MSEC(50));
-}
+// PWM periods in nanoseconds, 0 terminated
+static const uint32_t sound_ble_0[] = {1000000, 500000, 250000, 100000, 50000, 0};
+static const uint32_t sound_ble_1[] = {1500000, 3900000, 1500000, 1500000, 0};
+static const uint32_t sound_ble_2[] = {1500000, 3900000, 0};
+static const uint32_t sound_ble_3[] = {2000000, 3900000, 0};
+static const uint32_t sound_ble_4[] = {2500000, 3900000, 0};
+static const uint32_t sound_usb[] = {3000000, 1500000, 750000, 0};
 
-static void play_sound_ble_0() {
-    _play(1000000);
-    _play(500000);
-    _play(250000);
-    _play(100000);
-    _play(50000);
-}
+static const uint32_t *const sounds[] = {
+    sound_ble_0, sound_ble_1, sound_ble_2, sound_ble_3, sound_ble_4, sound_usb,
+};
 
-static void play_sound_ble_1() {
-    _play(1500000);
-    _play(3900000);
-    _play(1500000);
-    _play(1500000);
-}
+#define SOUND_USB 5
 
-static void play_sound_ble_2() {
-    _play(1500000);
-    _play(3900000);
-}
+// sound index requested by listener, -1 if none
+static atomic_t requested_sound = ATOMIC_INIT(-1);
+static const uint32_t *playing;
+static bool tone_on;
 
-static void play_sound_ble_3() {
-    _play(2000000);
-    _play(3900000);
-}
+static void sequencer_work_handler(struct k_work *work);
 
-static void play_sound_ble_4() {
-    _play(2500000);
-    _play(3900000);
-}
+static K_WORK_DELAYABLE_DEFINE(sequencer_work, sequencer_work_handler);
 
-static void play_sound_usb() {
-    _play(3000000);
-    _play(1500000);
-    _play(750000);
+// runs on the system work queue, one step per note edge.
+// a new request cancels the sound currently playing.
+static void sequencer_work_handler(struct k_work *work) {
+    atomic_val_t index = atomic_set(&requested_sound, -1);
+    if (index >= 0) {
+        playing = sounds[index];
+        tone_on = false;
+    }
+    if (playing == NULL) {
+        return;
+    }
+    if (tone_on) {
+        pwm_set_dt(&pwm, 0, 0);
+        tone_on = false;
+        playing++;
+        k_work_reschedule(&sequencer_work, BEEP_INTERVAL);
+        return;
+    }
+    if (*playing == 0) {
+        playing = NULL;
+        return;
+    }
+    pwm_set_dt(&pwm, *playing, *playing / 2U);
+    tone_on = true;
+    k_work_reschedule(&sequencer_work, BEEP_DURATION);
 }
 
-static void play_sound(uint8_t index) {
-    switch (index) {
-    case 0:
-        play_sound_ble_0();
-        break;
-    case 1:
-        play_sound_ble_1();
-        break;
-    case 2:
-        play_sound_ble_2();
-        break;
-    case 3:
-        play_sound_ble_3();
-        break;
-    case 4:
-        play_sound_ble_4();
-        break;
-    case 5:
-        play_sound_usb();
-        break;
-    default:
-        break;
+static void play_sound(int index) {
+    if (index < 0 || index >= ARRAY_SIZE(sounds)) {
+        return;
+    }
+    if (!device_is_ready(pwm.dev)) {
+        LOG_ERR("PWM device %s is not ready", pwm.dev->name);
+        return;
     }
+    atomic_set(&requested_sound, index);
+    k_work_reschedule(&sequencer_work, K_NO_WAIT);
 }
 
 int buzzer_listener(const zmk_event_t *eh) {
@@ -110,7 +101,7 @@ int buzzer_listener(const zmk_event_t *eh) {
     int new_index = -1;
     switch (zmk_endpoints_selected().transport) {
     case ZMK_TRANSPORT_USB:
-        new_index = 5;
+        new_index = SOUND_USB;
         break;
     case ZMK_TRANSPORT_BLE:
         new_index = zmk_ble_active_profile_index();
@@ -0,0 +1,47 @@
+// bit-sliced debounce of kscan_gpio_matrix_bitwise, one 32bit word per strobe.
+//
+// counter[b] holds bit b of a 5 bits counter for each input, so all inputs of a strobe are
+// counted by a few bitwise operations. no hardware access, shared with the unit tests.
+
+#pragma once
+
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+// 5 bits vertical counter, up to 31 samples
+#define KSCAN_BITWISE_COUNTER_BITS 5
+#define KSCAN_BITWISE_COUNTER_MAX (BIT(KSCAN_BITWISE_COUNTER_BITS) - 1)
+
+// bits where the counter equals the value
+static inline uint32_t kscan_bitwise_counter_equals(
+  const uint32_t counter[KSCAN_BITWISE_COUNTER_BITS], uint8_t value) {
+  uint32_t eq = UINT32_MAX;
+  for (int b = 0; b < KSCAN_BITWISE_COUNTER_BITS; b++) {
+    eq &= (value & BIT(b)) ? counter[b] : ~counter[b];
+  }
+  return eq;
+}
+
+// debounce one strobe, returns changed bits.
+static inline uint32_t kscan_bitwise_debounce(uint32_t *debounced,
+                                              uint32_t counter[KSCAN_BITWISE_COUNTER_BITS],
+                                              uint32_t raw, uint8_t press_samples,
+                                              uint8_t release_samples) {
+  uint32_t diff = raw ^ *debounced;
+  // increment where raw differs from debounced state, reset elsewhere
+  uint32_t carry = diff;
+  for (int b = 0; b < KSCAN_BITWISE_COUNTER_BITS; b++) {
+    uint32_t next_carry = counter[b] & carry;
+    counter[b] = (counter[b] ^ carry) & diff;
+    carry = next_carry;
+  }
+  uint32_t changed = diff & ((raw & kscan_bitwise_counter_equals(counter, press_samples)) |
+                             (~raw & kscan_bitwise_counter_equals(counter, release_samples)));
+  if (changed) {
+    *debounced ^= changed;
+    for (int b = 0; b < KSCAN_BITWISE_COUNTER_BITS; b++) {
+      counter[b] &= ~changed;
+    }
+  }
+  return changed;
+}
@@ -0,0 +1,467 @@
+// electro-capacitive matrix scanner, port of qmk_keyboards/ec_60/ec_switch_matrix.c
+//
+// keys are read one by one from the scan thread, same sequence as ec_readkey() of QMK:
+// wait until the peak-hold capacitor has been discharged for discharge-time-us, stop discharging
+// and strobe the row, busy-wait charge-time-us, then one ADC conversion. the peak-hold value
+// decays, so the conversion follows the strobe by microseconds, never by a kernel tick.
+// columns are switched once per column (column major), the first key of a scan is read twice to
+// equalize its discharge time.
+//
+// a scan takes about rows * cols * (discharge-time-us + charge-time-us + conversion time), the
+// scan thread busy-waits for all of it. the measured scan time is logged after startup
+// calibration, the scan period is the max of it and scan-period-ms.
+//
+// calibration
+// - noise floor: averaged at startup, then tracked while all keys are released
+// - bottoming: max reading while pressed, updated every N actuations
+// calibration is not persisted.
+
+#define DT_DRV_COMPAT zmk_kscan_ec_matrix
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/kscan.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+// samples for initial noise floor
+#define INIT_SCANS 5
+// noise floor tracking, floor_acc = floor << FLOOR_SHIFT
+#define FLOOR_SHIFT 4
+
+struct ec_key {
+  uint16_t floor;
+  uint16_t bottoming;
+  uint16_t noise;
+  uint16_t deadzone;
+  uint16_t actuation;
+  uint16_t release;
+  uint16_t sensitivity;
+  uint16_t extremum;
+  uint16_t bottoming_max;
+  uint32_t floor_acc;
+  uint8_t actuation_count;
+  bool pressed;
+};
+
+struct kscan_ec_config {
+  struct adc_dt_spec adc;
+  const struct gpio_dt_spec *strobes;
+  const struct gpio_dt_spec *amux_sel;
+  const struct gpio_dt_spec *amux_en;
+  struct gpio_dt_spec discharge;
+  const uint8_t *col_channels;
+  // per key, NULL if not defined
+  const uint8_t *actuation_percents;
+  uint8_t rows;
+  uint8_t cols;
+  uint8_t amux_sel_len;
+  uint8_t amux_en_len;
+  uint16_t discharge_time_us;
+  uint16_t charge_time_us;
+  uint16_t scan_period_ms;
+  uint16_t bottoming_reading;
+  uint8_t deadzone_percent;
+  uint8_t actuation_percent;
+  uint8_t release_percent;
+  uint8_t rapid_trigger_percent;
+  k_thread_stack_t *stack;
+  size_t stack_size;
+};
+
+struct kscan_ec_data {
+  const struct device *dev;
+  kscan_callback_t callback;
+  atomic_t enabled;
+  struct k_sem enable_sem;
+  struct k_thread thread;
+  struct adc_sequence sequence;
+  uint16_t sample;
+  uint8_t selected_col;
+  // cycle count when the peak-hold capacitor started discharging
+  uint32_t discharged_at;
+  uint8_t init_scans;
+  int64_t released_since;
+  uint16_t *samples;
+  struct ec_key *keys;
+};
+
+static void select_col(const struct device *dev, uint8_t col) {
+  const struct kscan_ec_config *config = dev->config;
+  struct kscan_ec_data *data = dev->data;
+  uint8_t channel = config->col_channels[col];
+  uint8_t prev = config->col_channels[data->selected_col];
+  data->selected_col = col;
+  if ((channel >> 4) != (prev >> 4)) {
+    gpio_pin_set_dt(&config->amux_en[prev >> 4], 0);
+    gpio_pin_set_dt(&config->amux_en[channel >> 4], 1);
+  }
+  uint8_t changes = channel ^ prev;
+  for (int i = 0; i < config->amux_sel_len; i++) {
+    if (changes & BIT(i)) {
+      gpio_pin_set_dt(&config->amux_sel[i], channel & BIT(i));
+    }
+  }
+}
+
+// discharge, strobe and read one key of the selected column
+static uint16_t read_key(const struct device *dev, uint8_t row) {
+  const struct kscan_ec_config *config = dev->config;
+  struct kscan_ec_data *data = dev->data;
+  uint32_t discharge_cycles = k_us_to_cyc_ceil32(config->discharge_time_us);
+  while (k_cycle_get_32() - data->discharged_at < discharge_cycles) {
+  }
+  // charge peak hold capacitor
+  gpio_pin_set_dt(&config->discharge, 0);
+  gpio_pin_set_dt(&config->strobes[row], 1);
+  k_busy_wait(config->charge_time_us);
+  int err = adc_read(config->adc.dev, &data->sequence);
+  gpio_pin_set_dt(&config->strobes[row], 0);
+  // discharge peak hold capacitor
+  gpio_pin_set_dt(&config->discharge, 1);
+  data->discharged_at = k_cycle_get_32();
+  if (err) {
+    LOG_ERR("Failed to read ADC (%d)", err);
+    return 0;
+  }
+  return data->sample;
+}
+
+// reads all keys into samples, row major
+static void read_matrix(const struct device *dev) {
+  const struct kscan_ec_config *config = dev->config;
+  struct kscan_ec_data *data = dev->data;
+  for (uint8_t col = 0; col < config->cols; col++) {
+    if (col != data->selected_col) {
+      select_col(dev, col);
+    }
+    for (uint8_t row = 0; row < config->rows; row++) {
+      if (col == 0 && row == 0) {
+        // dummy reading for equalize discharge time
+        read_key(dev, row);
+      }
+      data->samples[row * config->cols + col] = read_key(dev, row);
+    }
+  }
+  // back to the first column while idle
+  select_col(dev, 0);
+}
+
+static void update_thresholds(const struct device *dev, struct ec_key *key, uint8_t row,
+                              uint8_t col) {
+  const struct kscan_ec_config *config = dev->config;
+  uint8_t actuation_percent = config->actuation_percent;
+  if (config->actuation_percents && config->actuation_percents[row * config->cols + col]) {
+    actuation_percent = config->actuation_percents[row * config->cols + col];
+  }
+  uint32_t travel = key->bottoming > key->floor ? key->bottoming - key->floor : 1;
+  key->deadzone = key->floor + MAX(key->noise, travel * config->deadzone_percent / 100);
+  key->actuation = key->floor + travel * actuation_percent / 100;
+  key->release = key->floor + travel * config->release_percent / 100;
+  key->sensitivity = travel * config->rapid_trigger_percent / 100;
+}
+
+static void init_floor(const struct device *dev, struct ec_key *key, uint8_t row, uint8_t col,
+                       uint16_t value) {
+  struct kscan_ec_data *data = dev->data;
+  // min: extremum, max: bottoming_max
+  if (data->init_scans == 0) {
+    key->extremum = value;
+    key->bottoming_max = value;
+  }
+  key->extremum = MIN(key->extremum, value);
+  key->bottoming_max = MAX(key->bottoming_max, value);
+  if (data->init_scans == INIT_SCANS - 1) {
+    key->noise = key->bottoming_max - key->extremum;
+    key->floor = (key->bottoming_max + key->extremum) / 2;
+    key->floor_acc = key->floor << FLOOR_SHIFT;
+    key->extremum = key->floor;
+    key->bottoming_max = 0;
+    update_thresholds(dev, key, row, col);
+  }
+}
+
+// returns true if key state changed
+static bool update_key(struct ec_key *key, uint16_t value) {
+  uint16_t extremum = MAX(value, key->deadzone);
+  if (key->pressed) {
+    key->bottoming_max = MAX(key->bottoming_max, value);
+    bool released = value <= key->deadzone ||
+                    (key->sensitivity ? key->extremum > value &&
+                                          key->extremum - value > key->sensitivity
+                                      : value < key->release);
+    if (released) {
+      key->pressed = false;
+      key->extremum = extremum;
+      return true;
+    }
+    // still moving down
+    key->extremum = MAX(key->extremum, extremum);
+  } else {
+    bool actuated = value > key->deadzone &&
+                    (key->sensitivity ? value > key->extremum &&
+                                          value - key->extremum > key->sensitivity
+                                      : value > key->actuation);
+    if (actuated) {
+      key->pressed = true;
+      key->extremum = extremum;
+      key->actuation_count++;
+      return true;
+    }
+    // still moving up
+    key->extremum = MIN(key->extremum, extremum);
+  }
+  return false;
+}
+
+static void calibrate_bottoming(const struct device *dev, struct ec_key *key, uint8_t row,
+                                uint8_t col) {
+  if (key->actuation_count < CONFIG_ZMK_KSCAN_EC_MATRIX_BOTTOMING_ACTUATIONS) {
+    return;
+  }
+  if (key->bottoming_max > key->floor + key->noise) {
+    key->bottoming = key->bottoming_max - (key->noise >> 1);
+    update_thresholds(dev, key, row, col);
+  }
+  key->actuation_count = 0;
+  key->bottoming_max = 0;
+}
+
+static void calibrate_floor(const struct device *dev, struct ec_key *key, uint8_t row, uint8_t col,
+                            uint16_t value) {
+  if (value >= key->deadzone) {
+    return;
+  }
+  key->floor_acc += value - (key->floor_acc >> FLOOR_SHIFT);
+  uint16_t floor = key->floor_acc >> FLOOR_SHIFT;
+  if (floor != key->floor) {
+    key->floor = floor;
+    update_thresholds(dev, key, row, col);
+  }
+}
+
+static void process_scan(const struct device *dev, const uint16_t *samples) {
+  const struct kscan_ec_config *config = dev->config;
+  struct kscan_ec_data *data = dev->data;
+  bool initializing = data->init_scans < INIT_SCANS;
+  bool idle = !initializing && k_uptime_get() - data->released_since >=
+                                 CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATION_IDLE_MS;
+  bool any_pressed = false;
+  for (uint8_t row = 0; row < config->rows; row++) {
+    for (uint8_t col = 0; col < config->cols; col++) {
+      struct ec_key *key = &data->keys[row * config->cols + col];
+      uint16_t value = samples[row * config->cols + col];
+      if (initializing) {
+        init_floor(dev, key, row, col, value);
+        continue;
+      }
+      if (update_key(key, value)) {
+        LOG_DBG("Sending event at %i,%i state %s", row, col, key->pressed ? "on" : "off");
+        data->callback(dev, row, col, key->pressed);
+        if (!key->pressed) {
+          calibrate_bottoming(dev, key, row, col);
+        }
+      }
+      if (key->pressed) {
+        any_pressed = true;
+      } else if (idle) {
+        calibrate_floor(dev, key, row, col, value);
+      }
+    }
+  }
+  if (initializing) {
+    data->init_scans++;
+  }
+  if (initializing || any_pressed) {
+    data->released_since = k_uptime_get();
+  }
+}
+
+static void kscan_ec_thread(void *p1, void *p2, void *p3) {
+  const struct device *dev = p1;
+  const struct kscan_ec_config *config = dev->config;
+  struct kscan_ec_data *data = dev->data;
+
+  while (true) {
+    if (!atomic_get(&data->enabled)) {
+      k_sem_take(&data->enable_sem, K_FOREVER);
+      continue;
+    }
+    int64_t next_scan = k_uptime_get() + config->scan_period_ms;
+    uint32_t start = k_cycle_get_32();
+    read_matrix(dev);
+    if (data->init_scans == INIT_SCANS - 1) {
+      LOG_INF("EC matrix scan takes %u us, scan period %u ms",
+              k_cyc_to_us_ceil32(k_cycle_get_32() - start), config->scan_period_ms);
+    }
+    process_scan(dev, data->samples);
+    // a tick for lower priority threads when the scan is longer than the period
+    int64_t now = k_uptime_get();
+    k_sleep(next_scan > now ? K_TIMEOUT_ABS_MS(next_scan) : K_TICKS(1));
+  }
+}
+
+static int kscan_ec_configure(const struct device *dev, kscan_callback_t callback) {
+  struct kscan_ec_data *data = dev->data;
+  if (!callback) {
+    return -EINVAL;
+  }
+  data->callback = callback;
+  return 0;
+}
+
+static int kscan_ec_enable(const struct device *dev) {
+  struct kscan_ec_data *data = dev->data;
+  atomic_set(&data->enabled, 1);
+  k_sem_give(&data->enable_sem);
+  return 0;
+}
+
+static int kscan_ec_disable(const struct device *dev) {
+  struct kscan_ec_data *data = dev->data;
+  atomic_set(&data->enabled, 0);
+  return 0;
+}
+
+static int configure_outputs(const struct gpio_dt_spec *gpios, uint8_t len, gpio_flags_t flags) {
+  for (int i = 0; i < len; i++) {
+    if (!device_is_ready(gpios[i].port)) {
+      LOG_ERR("GPIO is not ready: %s", gpios[i].port->name);
+      return -ENODEV;
+    }
+    int err = gpio_pin_configure_dt(&gpios[i], flags);
+    if (err) {
+      LOG_ERR("Unable to configure pin %u on %s for output", gpios[i].pin, gpios[i].port->name);
+      return err;
+    }
+  }
+  return 0;
+}
+
+static int kscan_ec_init(const struct device *dev) {
+  const struct kscan_ec_config *config = dev->config;
+  struct kscan_ec_data *data = dev->data;
+  int err;
+  data->dev = dev;
+
+  if (!adc_is_ready_dt(&config->adc)) {
+    LOG_ERR("ADC is not ready: %s", config->adc.dev->name);
+    return -ENODEV;
+  }
+  err = adc_channel_setup_dt(&config->adc);
+  if (err) {
+    return err;
+  }
+  err = adc_sequence_init_dt(&config->adc, &data->sequence);
+  if (err) {
+    return err;
+  }
+  data->sequence.buffer = &data->sample;
+  data->sequence.buffer_size = sizeof(data->sample);
+
+  // discharging
+  err = configure_outputs(&config->discharge, 1, GPIO_OUTPUT_ACTIVE);
+  if (!err) {
+    err = configure_outputs(config->strobes, config->rows, GPIO_OUTPUT_INACTIVE);
+  }
+  if (!err) {
+    err = configure_outputs(config->amux_sel, config->amux_sel_len, GPIO_OUTPUT_INACTIVE);
+  }
+  if (!err) {
+    err = configure_outputs(config->amux_en, config->amux_en_len, GPIO_OUTPUT_INACTIVE);
+  }
+  if (err) {
+    return err;
+  }
+  // select first column, select_col() only writes changed pins
+  data->selected_col = 0;
+  for (int i = 0; i < config->amux_en_len; i++) {
+    gpio_pin_set_dt(&config->amux_en[i], (config->col_channels[0] >> 4) == i);
+  }
+  for (int i = 0; i < config->amux_sel_len; i++) {
+    gpio_pin_set_dt(&config->amux_sel[i], config->col_channels[0] & BIT(i));
+  }
+
+  for (int i = 0; i < config->rows * config->cols; i++) {
+    data->keys[i].bottoming = config->bottoming_reading;
+  }
+
+  data->discharged_at = k_cycle_get_32();
+  k_sem_init(&data->enable_sem, 0, 1);
+  k_thread_create(&data->thread, config->stack, config->stack_size, kscan_ec_thread, (void *)dev,
+                  NULL, NULL, CONFIG_ZMK_KSCAN_EC_MATRIX_THREAD_PRIORITY, 0, K_NO_WAIT);
+  k_thread_name_set(&data->thread, dev->name);
+  return 0;
+}
+
+static const struct kscan_driver_api kscan_ec_api = {
+  .config = kscan_ec_configure,
+  .enable_callback = kscan_ec_enable,
+  .disable_callback = kscan_ec_disable,
+};
+
+#define INST_ROWS(n) DT_INST_PROP_LEN(n, strobe_gpios)
+#define INST_COLS(n) DT_INST_PROP_LEN(n, col_channels)
+#define INST_GPIOS(n, prop) \
+  {DT_INST_FOREACH_PROP_ELEM_SEP(n, prop, GPIO_DT_SPEC_GET_BY_IDX, (, ))}
+
+#define INST_ACTUATION_PERCENTS(n)                                                        \
+  COND_CODE_1(DT_INST_NODE_HAS_PROP(n, actuation_percents),                               \
+              (BUILD_ASSERT(DT_INST_PROP_LEN(n, actuation_percents) ==                    \
+                              INST_ROWS(n) * INST_COLS(n),                                \
+                            "actuation-percents must have rows * cols elements");         \
+               static const uint8_t kscan_ec_actuation_percents_##n[] =                   \
+                 DT_INST_PROP(n, actuation_percents);),                                   \
+              ())
+
+#define KSCAN_EC_INIT(n)                                                                          \
+  BUILD_ASSERT(DT_INST_PROP_LEN(n, amux_sel_gpios) <= 4, "too many amux-sel-gpios");              \
+  BUILD_ASSERT(DT_INST_PROP_LEN(n, amux_en_gpios) <= 4, "too many amux-en-gpios");                \
+                                                                                                  \
+  static const struct gpio_dt_spec kscan_ec_strobes_##n[] = INST_GPIOS(n, strobe_gpios);          \
+  static const struct gpio_dt_spec kscan_ec_amux_sel_##n[] = INST_GPIOS(n, amux_sel_gpios);       \
+  static const struct gpio_dt_spec kscan_ec_amux_en_##n[] = INST_GPIOS(n, amux_en_gpios);         \
+  static const uint8_t kscan_ec_col_channels_##n[] = DT_INST_PROP(n, col_channels);               \
+  INST_ACTUATION_PERCENTS(n)                                                                      \
+  static uint16_t kscan_ec_samples_##n[INST_ROWS(n) * INST_COLS(n)];                              \
+  static struct ec_key kscan_ec_keys_##n[INST_ROWS(n) * INST_COLS(n)];                            \
+  K_THREAD_STACK_DEFINE(kscan_ec_stack_##n, CONFIG_ZMK_KSCAN_EC_MATRIX_THREAD_STACK_SIZE);        \
+                                                                                                  \
+  static struct kscan_ec_data kscan_ec_data_##n = {                                               \
+    .samples = kscan_ec_samples_##n,                                                              \
+    .keys = kscan_ec_keys_##n,                                                                    \
+  };                                                                                              \
+                                                                                                  \
+  static const struct kscan_ec_config kscan_ec_config_##n = {                                     \
+    .adc = ADC_DT_SPEC_INST_GET(n),                                                               \
+    .strobes = kscan_ec_strobes_##n,                                                              \
+    .amux_sel = kscan_ec_amux_sel_##n,                                                            \
+    .amux_en = kscan_ec_amux_en_##n,                                                              \
+    .discharge = GPIO_DT_SPEC_INST_GET(n, discharge_gpios),                                       \
+    .col_channels = kscan_ec_col_channels_##n,                                                    \
+    .actuation_percents = COND_CODE_1(DT_INST_NODE_HAS_PROP(n, actuation_percents),               \
+                                      (kscan_ec_actuation_percents_##n), (NULL)),                 \
+    .rows = INST_ROWS(n),                                                                         \
+    .cols = INST_COLS(n),                                                                         \
+    .amux_sel_len = DT_INST_PROP_LEN(n, amux_sel_gpios),                                          \
+    .amux_en_len = DT_INST_PROP_LEN(n, amux_en_gpios),                                            \
+    .discharge_time_us = DT_INST_PROP(n, discharge_time_us),                                      \
+    .charge_time_us = DT_INST_PROP(n, charge_time_us),                                            \
+    .scan_period_ms = DT_INST_PROP(n, scan_period_ms),                                            \
+    .bottoming_reading = DT_INST_PROP(n, bottoming_reading),                                      \
+    .deadzone_percent = DT_INST_PROP(n, deadzone_percent),                                        \
+    .actuation_percent = DT_INST_PROP(n, actuation_percent),                                      \
+    .release_percent = DT_INST_PROP(n, release_percent),                                          \
+    .rapid_trigger_percent = DT_INST_PROP(n, rapid_trigger_percent),                              \
+    .stack = kscan_ec_stack_##n,                                                                  \
+    .stack_size = K_THREAD_STACK_SIZEOF(kscan_ec_stack_##n),                                      \
+  };                                                                                              \
+                                                                                                  \
+  DEVICE_DT_INST_DEFINE(n, &kscan_ec_init, NULL, &kscan_ec_data_##n, &kscan_ec_config_##n,        \
+                        POST_KERNEL, CONFIG_KSCAN_INIT_PRIORITY, &kscan_ec_api);
+
+DT_INST_FOREACH_STATUS_OKAY(KSCAN_EC_INIT);
@@ -0,0 +1,272 @@
+// GPIO matrix scanner for larger matrices on slower MCUs.
+//
+// - each strobe reads the input ports once, instead of calling gpio_pin_get per key
+// - inputs of a strobe are packed into one 32bit word
+// - debounce counters are bit-sliced (vertical counters), so all keys of a strobe are
+//   debounced by a few bitwise operations
+//
+// debouncing follows the same semantics as ZMK's kscan_gpio_matrix, a key changes state
+// after (debounce-*-ms / debounce-scan-period-ms + 1) consecutive samples.
+// debounce-press-ms = 0 means eager press.
+
+#define DT_DRV_COMPAT zmk_kscan_gpio_matrix_bitwise
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/kscan.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include "kscan_bitwise_debounce.h"
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define INPUTS_MAX 32
+
+#define DIODE_ROW2COL 0
+#define DIODE_COL2ROW 1
+
+struct kscan_bitwise_config {
+  const struct gpio_dt_spec *rows;
+  const struct gpio_dt_spec *cols;
+  uint8_t rows_len;
+  uint8_t cols_len;
+  uint8_t diode_direction;
+  uint8_t press_samples;
+  uint8_t release_samples;
+  uint16_t scan_period_ms;
+};
+
+struct kscan_bitwise_data {
+  const struct device *dev;
+  kscan_callback_t callback;
+  struct k_work_delayable work;
+  int64_t scan_time;
+  // input pins grouped by port
+  const struct device *ports[INPUTS_MAX];
+  uint8_t ports_len;
+  uint8_t port_index[INPUTS_MAX];
+  uint8_t pin[INPUTS_MAX];
+  uint32_t active_low_mask;
+  // per output(strobe)
+  uint32_t *debounced;
+  uint32_t (*counter)[KSCAN_BITWISE_COUNTER_BITS];
+};
+
+static inline const struct gpio_dt_spec *outputs(const struct kscan_bitwise_config *config) {
+  return config->diode_direction == DIODE_COL2ROW ? config->cols : config->rows;
+}
+
+static inline const struct gpio_dt_spec *inputs(const struct kscan_bitwise_config *config) {
+  return config->diode_direction == DIODE_COL2ROW ? config->rows : config->cols;
+}
+
+static inline uint8_t outputs_len(const struct kscan_bitwise_config *config) {
+  return config->diode_direction == DIODE_COL2ROW ? config->cols_len : config->rows_len;
+}
+
+static inline uint8_t inputs_len(const struct kscan_bitwise_config *config) {
+  return config->diode_direction == DIODE_COL2ROW ? config->rows_len : config->cols_len;
+}
+
+static uint32_t read_inputs(const struct device *dev) {
+  const struct kscan_bitwise_config *config = dev->config;
+  struct kscan_bitwise_data *data = dev->data;
+  gpio_port_value_t values[INPUTS_MAX];
+  for (int i = 0; i < data->ports_len; i++) {
+    if (gpio_port_get_raw(data->ports[i], &values[i]) < 0) {
+      values[i] = 0;
+    }
+  }
+  uint32_t raw = 0;
+  for (int i = 0; i < inputs_len(config); i++) {
+    raw |= ((values[data->port_index[i]] >> data->pin[i]) & 1) << i;
+  }
+  return raw ^ data->active_low_mask;
+}
+
+static void notify(const struct device *dev, uint8_t output, uint32_t changed, uint32_t state) {
+  const struct kscan_bitwise_config *config = dev->config;
+  struct kscan_bitwise_data *data = dev->data;
+  while (changed) {
+    uint8_t input = __builtin_ctz(changed);
+    changed &= changed - 1;
+    bool pressed = state & BIT(input);
+    uint8_t row = config->diode_direction == DIODE_COL2ROW ? input : output;
+    uint8_t col = config->diode_direction == DIODE_COL2ROW ? output : input;
+    LOG_DBG("Sending event at %i,%i state %s", row, col, pressed ? "on" : "off");
+    data->callback(dev, row, col, pressed);
+  }
+}
+
+static void scan(const struct device *dev) {
+  const struct kscan_bitwise_config *config = dev->config;
+  struct kscan_bitwise_data *data = dev->data;
+  const struct gpio_dt_spec *out = outputs(config);
+  for (int o = 0; o < outputs_len(config); o++) {
+    gpio_pin_set_dt(&out[o], 1);
+#if CONFIG_ZMK_KSCAN_GPIO_MATRIX_BITWISE_WAIT_BEFORE_INPUTS > 0
+    k_busy_wait(CONFIG_ZMK_KSCAN_GPIO_MATRIX_BITWISE_WAIT_BEFORE_INPUTS);
+#endif
+    uint32_t raw = read_inputs(dev);
+    gpio_pin_set_dt(&out[o], 0);
+#if CONFIG_ZMK_KSCAN_GPIO_MATRIX_BITWISE_WAIT_BETWEEN_OUTPUTS > 0
+    k_busy_wait(CONFIG_ZMK_KSCAN_GPIO_MATRIX_BITWISE_WAIT_BETWEEN_OUTPUTS);
+#endif
+    uint32_t changed = kscan_bitwise_debounce(&data->debounced[o], data->counter[o], raw,
+                                              config->press_samples, config->release_samples);
+    if (changed) {
+      notify(dev, o, changed, data->debounced[o]);
+    }
+  }
+}
+
+static void scan_work_handler(struct k_work *work) {
+  struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+  struct kscan_bitwise_data *data = CONTAINER_OF(dwork, struct kscan_bitwise_data, work);
+  const struct kscan_bitwise_config *config = data->dev->config;
+  scan(data->dev);
+  // fixed rate, not fixed delay. skip missed periods if the work queue was busy.
+  data->scan_time += config->scan_period_ms;
+  int64_t now = k_uptime_get();
+  if (data->scan_time < now) {
+    data->scan_time = now;
+  }
+  k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
+}
+
+static int kscan_bitwise_configure(const struct device *dev, kscan_callback_t callback) {
+  struct kscan_bitwise_data *data = dev->data;
+  if (!callback) {
+    return -EINVAL;
+  }
+  data->callback = callback;
+  return 0;
+}
+
+static int kscan_bitwise_enable(const struct device *dev) {
+  struct kscan_bitwise_data *data = dev->data;
+  data->scan_time = k_uptime_get();
+  return k_work_reschedule(&data->work, K_NO_WAIT);
+}
+
+static int kscan_bitwise_disable(const struct device *dev) {
+  struct kscan_bitwise_data *data = dev->data;
+  k_work_cancel_delayable(&data->work);
+  return 0;
+}
+
+static int init_inputs(const struct device *dev) {
+  const struct kscan_bitwise_config *config = dev->config;
+  struct kscan_bitwise_data *data = dev->data;
+  const struct gpio_dt_spec *in = inputs(config);
+  for (int i = 0; i < inputs_len(config); i++) {
+    if (!device_is_ready(in[i].port)) {
+      LOG_ERR("GPIO is not ready: %s", in[i].port->name);
+      return -ENODEV;
+    }
+    int err = gpio_pin_configure_dt(&in[i], GPIO_INPUT);
+    if (err) {
+      LOG_ERR("Unable to configure pin %u on %s for input", in[i].pin, in[i].port->name);
+      return err;
+    }
+    uint8_t p = 0;
+    while (p < data->ports_len && data->ports[p] != in[i].port) {
+      p++;
+    }
+    if (p == data->ports_len) {
+      data->ports[data->ports_len++] = in[i].port;
+    }
+    data->port_index[i] = p;
+    data->pin[i] = in[i].pin;
+    if (in[i].dt_flags & GPIO_ACTIVE_LOW) {
+      data->active_low_mask |= BIT(i);
+    }
+  }
+  return 0;
+}
+
+static int init_outputs(const struct device *dev) {
+  const struct kscan_bitwise_config *config = dev->config;
+  const struct gpio_dt_spec *out = outputs(config);
+  for (int i = 0; i < outputs_len(config); i++) {
+    if (!device_is_ready(out[i].port)) {
+      LOG_ERR("GPIO is not ready: %s", out[i].port->name);
+      return -ENODEV;
+    }
+    int err = gpio_pin_configure_dt(&out[i], GPIO_OUTPUT_INACTIVE);
+    if (err) {
+      LOG_ERR("Unable to configure pin %u on %s for output", out[i].pin, out[i].port->name);
+      return err;
+    }
+  }
+  return 0;
+}
+
+static int kscan_bitwise_init(const struct device *dev) {
+  struct kscan_bitwise_data *data = dev->data;
+  data->dev = dev;
+  int err = init_inputs(dev);
+  if (err) {
+    return err;
+  }
+  err = init_outputs(dev);
+  if (err) {
+    return err;
+  }
+  k_work_init_delayable(&data->work, scan_work_handler);
+  return 0;
+}
+
+static const struct kscan_driver_api kscan_bitwise_api = {
+  .config = kscan_bitwise_configure,
+  .enable_callback = kscan_bitwise_enable,
+  .disable_callback = kscan_bitwise_disable,
+};
+
+#define INST_ROWS_LEN(n) DT_INST_PROP_LEN(n, row_gpios)
+#define INST_COLS_LEN(n) DT_INST_PROP_LEN(n, col_gpios)
+#define INST_DIODE_DIRECTION(n) DT_INST_ENUM_IDX(n, diode_direction)
+#define INST_INPUTS_LEN(n) \
+  (INST_DIODE_DIRECTION(n) == DIODE_COL2ROW ? INST_ROWS_LEN(n) : INST_COLS_LEN(n))
+#define INST_OUTPUTS_LEN(n) \
+  (INST_DIODE_DIRECTION(n) == DIODE_COL2ROW ? INST_COLS_LEN(n) : INST_ROWS_LEN(n))
+#define INST_SAMPLES(n, prop) \
+  (DT_INST_PROP(n, prop) / DT_INST_PROP(n, debounce_scan_period_ms) + 1)
+
+#define KSCAN_BITWISE_INIT(n)                                                                     \
+  BUILD_ASSERT(INST_INPUTS_LEN(n) <= INPUTS_MAX, "too many matrix inputs");                       \
+  BUILD_ASSERT(INST_SAMPLES(n, debounce_press_ms) <= KSCAN_BITWISE_COUNTER_MAX,                   \
+               "debounce-press-ms too long");                                                     \
+  BUILD_ASSERT(INST_SAMPLES(n, debounce_release_ms) <= KSCAN_BITWISE_COUNTER_MAX,                 \
+               "debounce-release-ms too long");                                                   \
+                                                                                                  \
+  static const struct gpio_dt_spec kscan_bitwise_rows_##n[] = {                                   \
+    DT_INST_FOREACH_PROP_ELEM_SEP(n, row_gpios, GPIO_DT_SPEC_GET_BY_IDX, (, ))};                  \
+  static const struct gpio_dt_spec kscan_bitwise_cols_##n[] = {                                   \
+    DT_INST_FOREACH_PROP_ELEM_SEP(n, col_gpios, GPIO_DT_SPEC_GET_BY_IDX, (, ))};                  \
+  static uint32_t kscan_bitwise_debounced_##n[INST_OUTPUTS_LEN(n)];                               \
+  static uint32_t kscan_bitwise_counter_##n[INST_OUTPUTS_LEN(n)][KSCAN_BITWISE_COUNTER_BITS];     \
+                                                                                                  \
+  static struct kscan_bitwise_data kscan_bitwise_data_##n = {                                     \
+    .debounced = kscan_bitwise_debounced_##n,                                                     \
+    .counter = kscan_bitwise_counter_##n,                                                         \
+  };                                                                                              \
+                                                                                                  \
+  static const struct kscan_bitwise_config kscan_bitwise_config_##n = {                           \
+    .rows = kscan_bitwise_rows_##n,                                                               \
+    .cols = kscan_bitwise_cols_##n,                                                               \
+    .rows_len = INST_ROWS_LEN(n),                                                                 \
+    .cols_len = INST_COLS_LEN(n),                                                                 \
+    .diode_direction = INST_DIODE_DIRECTION(n),                                                   \
+    .press_samples = INST_SAMPLES(n, debounce_press_ms),                                          \
+    .release_samples = INST_SAMPLES(n, debounce_release_ms),                                      \
+    .scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                                   \
+  };                                                                                              \
+                                                                                                  \
+  DEVICE_DT_INST_DEFINE(n, &kscan_bitwise_init, NULL, &kscan_bitwise_data_##n,                    \
+                        &kscan_bitwise_config_##n, POST_KERNEL, CONFIG_KSCAN_INIT_PRIORITY,       \
+                        &kscan_bitwise_api);
+
+DT_INST_FOREACH_STATUS_OKAY(KSCAN_BITWISE_INIT);
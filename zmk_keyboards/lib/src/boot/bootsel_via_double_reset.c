@@ -8,13 +8,19 @@
 
 static __noinit uint32_t magic;
 
+static void disarm_double_tap(struct k_work *work) { magic = 0; }
+
+static K_WORK_DELAYABLE_DEFINE(disarm_work, disarm_double_tap);
+
 static int boot_double_tap_check(void) {
   if (magic != CONFIG_BOOTSEL_VIA_DOUBLE_RESET_MAGIC) {
+    // armed during the window, boot continues without waiting.
+    // the system work queue is not started yet, but it will be before the timeout expires.
     magic = CONFIG_BOOTSEL_VIA_DOUBLE_RESET_MAGIC;
-    k_msleep(CONFIG_BOOTSEL_VIA_DOUBLE_RESET_TIMEOUT_MS);
-    magic = 0;
+    k_work_schedule(&disarm_work, K_MSEC(CONFIG_BOOTSEL_VIA_DOUBLE_RESET_TIMEOUT_MS));
     return 0;
   }
+  magic = 0;
   sys_reboot(CONFIG_BOOTSEL_VIA_DOUBLE_RESET_TYPE);
   return 0;
 }
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <zmk/endpoints_types.h>
+
+struct zmk_endpoint_instance zmk_endpoints_selected(void);
+int zmk_endpoints_send_radial_controller_report(void);
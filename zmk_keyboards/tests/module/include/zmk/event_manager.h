@@ -0,0 +1,66 @@
+#pragma once
+
+// stand-in of the ZMK event manager. raising an event records it, tests dispatch by calling
+// the listeners, so the order and the timing of each step are up to the test.
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+struct zmk_event_type {
+  const char *name;
+};
+
+typedef struct {
+  const struct zmk_event_type *event;
+} zmk_event_t;
+
+#define ZMK_EV_EVENT_BUBBLE 0
+#define ZMK_EV_EVENT_HANDLED 1
+#define ZMK_EV_EVENT_CAPTURED 2
+
+typedef int (*zmk_listener_callback_t)(const zmk_event_t *eh);
+struct zmk_listener {
+  zmk_listener_callback_t callback;
+};
+
+#define ZMK_EVENT_DECLARE(event_type)                                  \
+  struct event_type##_event {                                          \
+    zmk_event_t header;                                                \
+    struct event_type data;                                            \
+  };                                                                   \
+  int raise_##event_type(struct event_type);                           \
+  struct event_type *as_##event_type(const zmk_event_t *eh);           \
+  extern const struct zmk_event_type zmk_event_##event_type;           \
+  /* last raised event, number of events and uptime of the last one */ \
+  extern struct event_type##_event event_type##_last;                  \
+  extern int event_type##_raised;                                      \
+  extern int64_t event_type##_raised_at;
+
+#define ZMK_EVENT_IMPL(event_type)                                            \
+  const struct zmk_event_type zmk_event_##event_type = {.name = #event_type}; \
+  struct event_type##_event event_type##_last;                                \
+  int event_type##_raised;                                                    \
+  int64_t event_type##_raised_at;                                             \
+  int raise_##event_type(struct event_type data) {                            \
+    event_type##_last.header.event = &zmk_event_##event_type;                 \
+    event_type##_last.data = data;                                            \
+    event_type##_raised++;                                                    \
+    event_type##_raised_at = k_uptime_get();                                  \
+    return 0;                                                                 \
+  }                                                                           \
+  struct event_type *as_##event_type(const zmk_event_t *eh) {                 \
+    if (eh->event != &zmk_event_##event_type) {                               \
+      return NULL;                                                            \
+    }                                                                         \
+    return &((struct event_type##_event *)eh)->data;                          \
+  }
+
+// event to pass to a listener, e.g. ZMK_EVENT(zmk_layer_state_changed, .layer = 1)
+#define ZMK_EVENT(event_type, ...)                                        \
+  (&((struct event_type##_event){.header.event = &zmk_event_##event_type, \
+                                 .data = {__VA_ARGS__}})                  \
+      .header)
+
+#define ZMK_LISTENER(mod, cb) const struct zmk_listener zmk_listener_##mod = {.callback = cb};
+#define ZMK_LISTENER_EXTERN(mod) extern const struct zmk_listener zmk_listener_##mod
+#define ZMK_SUBSCRIPTION(mod, ev_type) extern const struct zmk_listener zmk_listener_##mod
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <zmk/event_manager.h>
+
+struct zmk_keycode_state_changed {
+  uint16_t usage_page;
+  uint32_t keycode;
+  bool state;
+  int64_t timestamp;
+};
+
+ZMK_EVENT_DECLARE(zmk_keycode_state_changed);
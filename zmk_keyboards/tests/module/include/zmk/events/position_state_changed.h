@@ -0,0 +1,12 @@
+#pragma once
+
+#include <zmk/event_manager.h>
+
+struct zmk_position_state_changed {
+  uint8_t source;
+  uint32_t position;
+  bool state;
+  int64_t timestamp;
+};
+
+ZMK_EVENT_DECLARE(zmk_position_state_changed);
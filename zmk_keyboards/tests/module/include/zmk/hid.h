@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+#include <zephyr/usb/class/hid.h>
+
+#define ZMK_HID_MAIN_VAL_DATA (0x00 << 0)
+#define ZMK_HID_MAIN_VAL_CONST (0x01 << 0)
+#define ZMK_HID_MAIN_VAL_ARRAY (0x00 << 1)
+#define ZMK_HID_MAIN_VAL_VAR (0x01 << 1)
+#define ZMK_HID_MAIN_VAL_ABS (0x00 << 2)
+#define ZMK_HID_MAIN_VAL_REL (0x01 << 2)
+
+void zmk_hid_radial_controller_button_press(void);
+void zmk_hid_radial_controller_button_release(void);
+void zmk_hid_radial_controller_dial_rotate(int16_t amount);
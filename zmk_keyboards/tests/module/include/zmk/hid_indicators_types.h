@@ -0,0 +1,5 @@
+#pragma once
+
+#include <stdint.h>
+
+typedef uint8_t zmk_hid_indicators_t;
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <stdint.h>
+
+int zmk_keymap_layer_to(uint8_t layer);
@@ -0,0 +1,28 @@
+#include <zephyr/ztest.h>
+
+// magic and the disarm work are static
+#include "boot/bootsel_via_double_reset.c"
+
+static uint32_t magic_at_application_init;
+static int64_t uptime_at_application_init;
+
+static int capture_boot(void) {
+  magic_at_application_init = magic;
+  uptime_at_application_init = k_uptime_get();
+  return 0;
+}
+
+SYS_INIT(capture_boot, APPLICATION, 0);
+
+ZTEST(bootsel_via_double_reset, test_armed_without_delaying_boot) {
+  zassert_equal(magic_at_application_init, CONFIG_BOOTSEL_VIA_DOUBLE_RESET_MAGIC);
+  zassert_true(uptime_at_application_init < CONFIG_BOOTSEL_VIA_DOUBLE_RESET_TIMEOUT_MS,
+               "boot waited %lld ms", (long long)uptime_at_application_init);
+}
+
+ZTEST(bootsel_via_double_reset, test_disarmed_after_window) {
+  k_msleep(CONFIG_BOOTSEL_VIA_DOUBLE_RESET_TIMEOUT_MS + 1);
+  zassert_equal(magic, 0);
+}
+
+ZTEST_SUITE(bootsel_via_double_reset, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,51 @@
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/ztest.h>
+
+#include <zmk/events/hid_indicators_changed.h>
+
+// app.overlay
+#define NUM_LOCK_PIN 1
+#define CAPS_LOCK_PIN 2
+
+#define NUM_LOCK BIT(0)
+#define CAPS_LOCK BIT(1)
+#define SCROLL_LOCK BIT(2)
+
+static const struct device *const gpio = DEVICE_DT_GET(DT_NODELABEL(gpio0));
+
+ZMK_LISTENER_EXTERN(indicator_led);
+
+static void set_indicators(zmk_hid_indicators_t indicators) {
+  zmk_listener_indicator_led.callback(
+    ZMK_EVENT(zmk_hid_indicators_changed, .indicators = indicators));
+}
+
+static void before(void *fixture) { set_indicators(0); }
+
+ZTEST(indicator_led, test_caps_lock) {
+  set_indicators(CAPS_LOCK);
+  zassert_equal(gpio_emul_output_get(gpio, CAPS_LOCK_PIN), 1);
+  zassert_equal(gpio_emul_output_get(gpio, NUM_LOCK_PIN), 0);
+  set_indicators(0);
+  zassert_equal(gpio_emul_output_get(gpio, CAPS_LOCK_PIN), 0);
+}
+
+ZTEST(indicator_led, test_only_changed_leds_are_updated) {
+  set_indicators(NUM_LOCK | CAPS_LOCK);
+  zassert_equal(gpio_emul_output_get(gpio, NUM_LOCK_PIN), 1);
+  zassert_equal(gpio_emul_output_get(gpio, CAPS_LOCK_PIN), 1);
+  // an LED set behind the listener's back stays as it is
+  gpio_pin_set_raw(gpio, CAPS_LOCK_PIN, 0);
+  set_indicators(CAPS_LOCK);
+  zassert_equal(gpio_emul_output_get(gpio, NUM_LOCK_PIN), 0);
+  zassert_equal(gpio_emul_output_get(gpio, CAPS_LOCK_PIN), 0);
+}
+
+ZTEST(indicator_led, test_indicator_without_led) {
+  set_indicators(SCROLL_LOCK);
+  zassert_equal(gpio_emul_output_get(gpio, NUM_LOCK_PIN), 0);
+  zassert_equal(gpio_emul_output_get(gpio, CAPS_LOCK_PIN), 0);
+}
+
+ZTEST_SUITE(indicator_led, NULL, NULL, before, NULL, NULL);
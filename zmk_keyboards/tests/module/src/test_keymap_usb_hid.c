@@ -0,0 +1,165 @@
+#include <errno.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+
+#include <zmk/events/usb_conn_state_changed.h>
+#include <zmk/keymap_hid.h>
+
+#include "zmk_fakes.h"
+
+// a response that can't be queued by then is dropped, keymap_usb_hid.c
+#define RESPONSE_TIMEOUT_MS 1000
+#define QUEUE_SIZE CONFIG_ZMK_KEYMAP_USB_HID_QUEUE_SIZE
+
+ZMK_LISTENER_EXTERN(keymap_usb_hid);
+
+static struct zmk_keymap_usb_hid_stats stats_before;
+// reports handed to the endpoint, in order
+static struct zmk_keymap_hid_report written[2 * QUEUE_SIZE];
+
+static int record_write(const struct device *dev, const uint8_t *data, uint32_t len,
+                        uint32_t *bytes_ret) {
+  zassert_equal(len, sizeof(struct zmk_keymap_hid_report));
+  if (hid_int_ep_write_fake.call_count <= ARRAY_SIZE(written)) {
+    memcpy(&written[hid_int_ep_write_fake.call_count - 1], data, len);
+  }
+  *bytes_ret = len;
+  return 0;
+}
+
+static size_t two_chunk_response(const uint8_t *request, size_t len, uint8_t *response,
+                                 size_t size) {
+  memset(response, 0xaa, KEYMAP_HID_CHUNK_MAX_PAYLOAD + 1);
+  return KEYMAP_HID_CHUNK_MAX_PAYLOAD + 1;
+}
+
+static void bus_status(enum usb_dc_status_code status) {
+  zmk_usb_get_status_fake.return_val = status;
+  zmk_listener_keymap_usb_hid.callback(
+    ZMK_EVENT(zmk_usb_conn_state_changed, .conn_state = ZMK_USB_CONN_HID));
+}
+
+static int send_report(uint8_t index) {
+  struct zmk_keymap_hid_report report = {.report_id = KEYMAP_HID_REPORT_ID,
+                                         .body = {.seq = index}};
+  return zmk_keymap_hid_usb_hid_send_report((uint8_t *)&report, sizeof(report));
+}
+
+// host polled the IN endpoint
+static void in_ready(void) { zmk_fakes_hid_ops->int_in_ready(NULL); }
+
+// host sends a single chunk request through SET_REPORT(Output)
+static void request(uint8_t seq) {
+  struct zmk_keymap_hid_report report = {.report_id = KEYMAP_HID_REPORT_ID,
+                                         .body = {.seq = seq, .len = 1, .payload = {0x01}}};
+  uint8_t *data = (uint8_t *)&report;
+  int32_t len = sizeof(report);
+  zmk_fakes_hid_ops->set_report(NULL, NULL, &len, &data);
+}
+
+#define STAT(name) (zmk_keymap_hid_usb_hid_get_stats().name - stats_before.name)
+
+static void before(void *fixture) {
+  zmk_fakes_reset();
+  // ends what the previous test left in flight
+  bus_status(USB_DC_RESET);
+  zmk_usb_get_status_fake.return_val = USB_DC_CONFIGURED;
+  hid_int_ep_write_fake.custom_fake = record_write;
+  zmk_keymap_hid_handle_message_fake.custom_fake = two_chunk_response;
+  stats_before = zmk_keymap_hid_usb_hid_get_stats();
+}
+
+ZTEST(keymap_usb_hid, test_queue_depth) {
+  // one armed on the endpoint, the rest queued
+  for (int i = 0; i < QUEUE_SIZE + 1; i++) {
+    zassert_ok(send_report(i));
+  }
+  zassert_equal(send_report(QUEUE_SIZE + 1), -EAGAIN);
+  zassert_equal(hid_int_ep_write_fake.call_count, 1);
+  zassert_equal(zmk_keymap_hid_usb_hid_get_stats().max_depth, QUEUE_SIZE);
+  zassert_equal(STAT(busy), 1);
+
+  for (int i = 0; i < QUEUE_SIZE; i++) {
+    in_ready();
+  }
+  zassert_equal(hid_int_ep_write_fake.call_count, QUEUE_SIZE + 1);
+  for (int i = 0; i < QUEUE_SIZE + 1; i++) {
+    zassert_equal(written[i].body.seq, i, "report %d out of order", i);
+  }
+  zassert_equal(STAT(queued), QUEUE_SIZE + 1);
+  zassert_equal(STAT(sent), QUEUE_SIZE + 1);
+}
+
+ZTEST(keymap_usb_hid, test_armed_transfer_has_no_timeout) {
+  zassert_ok(send_report(0));
+  k_msleep(5 * RESPONSE_TIMEOUT_MS);
+  zassert_ok(send_report(1));
+  // host hasn't polled, second report waits
+  zassert_equal(hid_int_ep_write_fake.call_count, 1);
+  in_ready();
+  zassert_equal(hid_int_ep_write_fake.call_count, 2);
+}
+
+ZTEST(keymap_usb_hid, test_bus_reset_flushes_queue) {
+  for (int i = 0; i < 3; i++) {
+    zassert_ok(send_report(i));
+  }
+  bus_status(USB_DC_RESET);
+  bus_status(USB_DC_CONFIGURED);
+  zassert_ok(send_report(3));
+  zassert_equal(hid_int_ep_write_fake.call_count, 2);
+  zassert_equal(written[1].body.seq, 3);
+}
+
+ZTEST(keymap_usb_hid, test_suspended_bus_wakes_host) {
+  zmk_usb_get_status_fake.return_val = USB_DC_SUSPEND;
+  usb_wakeup_request_fake.return_val = -EAGAIN;
+  zassert_equal(send_report(0), -EAGAIN);
+  zassert_equal(usb_wakeup_request_fake.call_count, 1);
+  zassert_equal(hid_int_ep_write_fake.call_count, 0);
+}
+
+ZTEST(keymap_usb_hid, test_response_chunks) {
+  request(7);
+  k_msleep(1);
+  zassert_equal(zmk_keymap_hid_handle_message_fake.call_count, 1);
+  zassert_equal(hid_int_ep_write_fake.call_count, 1);
+  zassert_equal(written[0].body.seq, 7);
+  zassert_equal(written[0].body.ctrl, KEYMAP_HID_CHUNK_MORE);
+  in_ready();
+  zassert_equal(hid_int_ep_write_fake.call_count, 2);
+  zassert_equal(written[1].body.seq, 7);
+  zassert_equal(written[1].body.ctrl, 1);
+  zassert_equal(written[1].body.len, 1);
+}
+
+ZTEST(keymap_usb_hid, test_response_dropped_at_deadline) {
+  // host stopped polling with a full queue
+  for (int i = 0; i < QUEUE_SIZE + 1; i++) {
+    zassert_ok(send_report(i));
+  }
+  request(1);
+  k_msleep(RESPONSE_TIMEOUT_MS - 10);
+  zassert_equal(STAT(dropped), 0);
+  k_msleep(20);
+  zassert_equal(STAT(dropped), 1);
+  zassert_true(STAT(busy) > 1, "response was not retried");
+
+  // next request is handled
+  request(2);
+  k_msleep(1);
+  zassert_equal(zmk_keymap_hid_handle_message_fake.call_count, 2);
+}
+
+ZTEST(keymap_usb_hid, test_request_while_processing) {
+  for (int i = 0; i < QUEUE_SIZE + 1; i++) {
+    zassert_ok(send_report(i));
+  }
+  request(1);
+  k_msleep(1);
+  request(2);
+  k_msleep(1);
+  zassert_equal(zmk_keymap_hid_handle_message_fake.call_count, 1);
+}
+
+ZTEST_SUITE(keymap_usb_hid, NULL, NULL, before, NULL, NULL);
@@ -0,0 +1,114 @@
+#include <zephyr/ztest.h>
+
+#include <zmk/events/keycode_state_changed.h>
+#include <zmk/events/layer_state_changed.h>
+#include <zmk/events/position_state_changed.h>
+#include <zmk/perf.h>
+
+#include "zmk_fakes.h"
+
+// the listeners bracketing every other one, other listeners take the busy wait
+ZMK_LISTENER_EXTERN(_perf_begin);
+ZMK_LISTENER_EXTERN(zz_perf_end);
+
+static void begin(const zmk_event_t *eh) { zmk_listener__perf_begin.callback(eh); }
+static void end(const zmk_event_t *eh) { zmk_listener_zz_perf_end.callback(eh); }
+
+static struct zmk_perf_stats snapshot(void) {
+  struct zmk_perf_stats stats;
+  zmk_perf_snapshot(&stats);
+  return stats;
+}
+
+static void before(void *fixture) {
+  zmk_fakes_reset();
+  zmk_perf_reset();
+}
+
+ZTEST(perf, test_dispatch_time) {
+  const zmk_event_t *layer = ZMK_EVENT(zmk_layer_state_changed, .layer = 1, .state = true);
+  begin(layer);
+  k_busy_wait(250);
+  end(layer);
+  begin(layer);
+  k_busy_wait(50);
+  end(layer);
+
+  struct zmk_perf_stats stats = snapshot();
+  const struct zmk_perf_dispatch_stats *dispatch = &stats.dispatch[ZMK_PERF_EVENT_LAYER];
+  zassert_equal(dispatch->count, 2);
+  zassert_within(dispatch->max_us, 250, 1);
+  zassert_within(dispatch->total_us, 300, 2);
+  // not a keycode
+  zassert_equal(stats.usb_keycodes + stats.ble_keycodes, 0);
+}
+
+ZTEST(perf, test_keycode_latency_from_position) {
+  int64_t now = k_uptime_get();
+  const zmk_event_t *position =
+    ZMK_EVENT(zmk_position_state_changed, .position = 3, .state = true, .timestamp = now);
+  const zmk_event_t *keycode =
+    ZMK_EVENT(zmk_keycode_state_changed, .keycode = 4, .state = true, .timestamp = now);
+  begin(position);
+  k_busy_wait(100);
+  // raised by the keymap inside the position event
+  begin(keycode);
+  k_busy_wait(300);
+  end(keycode);
+  end(position);
+
+  struct zmk_perf_stats stats = snapshot();
+  zassert_equal(stats.kscan_events, 1);
+  zassert_within(stats.dispatch[ZMK_PERF_EVENT_KEYCODE].max_us, 300, 1);
+  zassert_within(stats.dispatch[ZMK_PERF_EVENT_POSITION].max_us, 400, 1);
+  zassert_within(stats.latency_max_us, 400, 1);
+  zassert_equal(stats.usb_keycodes, 1);
+  zassert_within(zmk_perf_latency_percentile_us(&stats, 50), 400, 1);
+}
+
+ZTEST(perf, test_deferred_keycode_latency) {
+  // tap released by a hold-tap timeout, after its position event ended
+  const zmk_event_t *keycode = ZMK_EVENT(zmk_keycode_state_changed, .keycode = 4, .state = true,
+                                         .timestamp = k_uptime_get());
+  k_msleep(30);
+  begin(keycode);
+  end(keycode);
+  zassert_within(snapshot().latency_max_us, 30 * USEC_PER_MSEC, USEC_PER_MSEC);
+}
+
+ZTEST(perf, test_kscan_delay) {
+  const zmk_event_t *position =
+    ZMK_EVENT(zmk_position_state_changed, .position = 3, .timestamp = k_uptime_get());
+  k_msleep(7);
+  begin(position);
+  end(position);
+  zassert_within(snapshot().kscan_delay_max_ms, 7, 1);
+}
+
+ZTEST(perf, test_keycodes_by_endpoint) {
+  const zmk_event_t *keycode =
+    ZMK_EVENT(zmk_keycode_state_changed, .keycode = 4, .timestamp = k_uptime_get());
+  begin(keycode);
+  end(keycode);
+  zmk_endpoints_selected_fake.return_val =
+    (struct zmk_endpoint_instance){.transport = ZMK_TRANSPORT_BLE};
+  begin(keycode);
+  end(keycode);
+
+  struct zmk_perf_stats stats = snapshot();
+  zassert_equal(stats.usb_keycodes, 1);
+  zassert_equal(stats.ble_keycodes, 1);
+}
+
+ZTEST(perf, test_reset) {
+  const zmk_event_t *layer = ZMK_EVENT(zmk_layer_state_changed, .layer = 1);
+  begin(layer);
+  end(layer);
+  k_msleep(10);
+  zmk_perf_reset();
+  struct zmk_perf_stats stats = snapshot();
+  zassert_equal(stats.dispatch[ZMK_PERF_EVENT_LAYER].count, 0);
+  zassert_equal(stats.since_ms, k_uptime_get());
+}
+
+ZTEST_SUITE(perf, NULL, NULL, before, NULL, NULL);
@@ -0,0 +1,107 @@
+#include <zephyr/device.h>
+#include <zephyr/ztest.h>
+
+#include <drivers/behavior.h>
+
+#include "zmk_fakes.h"
+
+// app.overlay
+#define DEGREES_PER_CLICK_X10 150
+#define REPEAT_INTERVAL_MS 100
+#define REPORT_INTERVAL_MS 10
+#define DIAL_MAX_X10 3600
+
+static const struct device *const dial = DEVICE_DT_GET(DT_NODELABEL(rc_dial));
+static const struct device *const button = DEVICE_DT_GET(DT_NODELABEL(rc_button));
+
+static int press(const struct device *dev) {
+  struct zmk_behavior_binding binding = {.behavior_dev = dev->name};
+  const struct behavior_driver_api *api = dev->api;
+  return api->binding_pressed(&binding, (struct zmk_behavior_binding_event){});
+}
+
+static int release(const struct device *dev) {
+  struct zmk_behavior_binding binding = {.behavior_dev = dev->name};
+  const struct behavior_driver_api *api = dev->api;
+  return api->binding_released(&binding, (struct zmk_behavior_binding_event){});
+}
+
+static void click(void) {
+  press(dial);
+  release(dial);
+}
+
+// rotation of the nth report, the dial is reset to 0 after each one
+static int16_t reported(int n) {
+  zassert_true(2 * n < zmk_hid_radial_controller_dial_rotate_fake.call_count, "no report %d", n);
+  zassert_equal(zmk_hid_radial_controller_dial_rotate_fake.arg0_history[2 * n + 1], 0);
+  return zmk_hid_radial_controller_dial_rotate_fake.arg0_history[2 * n];
+}
+
+static void before(void *fixture) {
+  zmk_fakes_reset();
+  zmk_report_interval_ms_fake.return_val = REPORT_INTERVAL_MS;
+  // rotation left by the previous test is flushed
+  k_msleep(DIAL_MAX_X10 / DEGREES_PER_CLICK_X10 * REPORT_INTERVAL_MS);
+  zmk_fakes_reset();
+  zmk_report_interval_ms_fake.return_val = REPORT_INTERVAL_MS;
+}
+
+ZTEST(rc_dial, test_first_click_without_delay) {
+  click();
+  k_msleep(1);
+  zassert_equal(zmk_endpoints_send_radial_controller_report_fake.call_count, 1);
+  zassert_equal(reported(0), DEGREES_PER_CLICK_X10);
+}
+
+ZTEST(rc_dial, test_clicks_coalesced_per_report_interval) {
+  click();
+  k_msleep(1);
+  click();
+  click();
+  k_msleep(REPORT_INTERVAL_MS / 2);
+  zassert_equal(zmk_endpoints_send_radial_controller_report_fake.call_count, 1);
+  k_msleep(REPORT_INTERVAL_MS);
+  zassert_equal(zmk_endpoints_send_radial_controller_report_fake.call_count, 2);
+  zassert_equal(reported(0), DEGREES_PER_CLICK_X10);
+  zassert_equal(reported(1), 2 * DEGREES_PER_CLICK_X10);
+}
+
+ZTEST(rc_dial, test_rotation_clamped) {
+  click();
+  k_msleep(1);
+  for (int i = 0; i < 29; i++) {
+    click();
+  }
+  k_msleep(3 * REPORT_INTERVAL_MS);
+  zassert_equal(zmk_endpoints_send_radial_controller_report_fake.call_count, 3);
+  zassert_equal(reported(0), DEGREES_PER_CLICK_X10);
+  zassert_equal(reported(1), DIAL_MAX_X10);
+  zassert_equal(reported(2), 29 * DEGREES_PER_CLICK_X10 - DIAL_MAX_X10);
+}
+
+ZTEST(rc_dial, test_repeat_while_held) {
+  press(dial);
+  k_msleep(3 * REPEAT_INTERVAL_MS + REPEAT_INTERVAL_MS / 2);
+  release(dial);
+  k_msleep(3 * REPEAT_INTERVAL_MS);
+  // click and 3 repeats, each one reported on its own
+  zassert_equal(zmk_endpoints_send_radial_controller_report_fake.call_count, 4);
+  for (int i = 0; i < 4; i++) {
+    zassert_equal(reported(i), DEGREES_PER_CLICK_X10);
+  }
+}
+
+ZTEST_SUITE(rc_dial, NULL, NULL, before, NULL, NULL);
+
+ZTEST(rc_button, test_press_release) {
+  zmk_endpoints_send_radial_controller_report_fake.return_val = -ENODEV;
+  zassert_equal(press(button), -ENODEV);
+  zassert_equal(zmk_hid_radial_controller_button_press_fake.call_count, 1);
+  zassert_equal(zmk_endpoints_send_radial_controller_report_fake.call_count, 1);
+  zassert_equal(release(button), -ENODEV);
+  zassert_equal(zmk_hid_radial_controller_button_release_fake.call_count, 1);
+  zassert_equal(zmk_endpoints_send_radial_controller_report_fake.call_count, 2);
+}
+
+ZTEST_SUITE(rc_button, NULL, NULL, before, NULL, NULL);
@@ -0,0 +1,45 @@
+#include <string.h>
+#include <zephyr/shell/shell_dummy.h>
+#include <zephyr/ztest.h>
+
+#include <zmk/perf.h>
+
+static const struct shell *sh;
+
+static void *setup(void) {
+  sh = shell_backend_dummy_get_ptr();
+  WAIT_FOR(shell_ready(sh), 20000, k_msleep(1));
+  zassert_true(shell_ready(sh), "shell not ready");
+  return NULL;
+}
+
+// output of the command
+static const char *run(const char *cmd) {
+  size_t size;
+  shell_backend_dummy_clear_output(sh);
+  zassert_ok(shell_execute_cmd(sh, cmd), "%s failed", cmd);
+  return shell_backend_dummy_get_output(sh, &size);
+}
+
+#define zassert_output(cmd, expected) \
+  zassert_not_null(strstr(run(cmd), expected), "%s: no \"%s\"", cmd, expected)
+
+ZTEST(shell, test_info_hello) { zassert_output("info hello", "hello!"); }
+
+ZTEST(shell, test_zmk_hello) { zassert_output("zmk hello", "hello!"); }
+
+ZTEST(shell, test_keymap_hid_stats) {
+  zassert_output("zmk keymap_hid_stats", "usb: queued:");
+  zassert_output("zmk keymap_hid_stats", "busy:");
+}
+
+ZTEST(shell, test_perf_snapshot) {
+  zmk_perf_reset();
+  zassert_output("zmk perf snapshot", "window: ");
+  zassert_output("zmk perf snapshot", "dispatch position: count:0 avg:0 us max:0 us");
+  zassert_output("zmk perf snapshot", "queue keymap usb: max_depth:");
+}
+
+ZTEST(shell, test_perf_reset) { zassert_output("zmk perf reset", "perf counters reset"); }
+
+ZTEST_SUITE(shell, NULL, setup, NULL, NULL, NULL);
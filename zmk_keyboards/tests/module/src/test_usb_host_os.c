@@ -0,0 +1,154 @@
+#include <zephyr/usb/class/hid.h>
+#include <zephyr/ztest.h>
+
+#include <zmk/events/endpoint_changed.h>
+#include <zmk/events/usb_conn_state_changed.h>
+#include <zmk/events/usb_host_os_changed.h>
+#include <zmk/usb_host_os.h>
+
+#include "zmk_fakes.h"
+
+// same captures as tests/unit/src/test_usb_host_os_signature.c, replayed with the host's timing
+#define SET_REPORT(type, id, len)                                                                  \
+  {.bmRequestType = 0x21, .bRequest = USB_HID_SET_REPORT, .wValue = (type) << 8 | (id),           \
+   .wIndex = 2, .wLength = (len)}
+#define OUTPUT_REPORT 2
+#define FEATURE_REPORT 3
+
+// end of detection without a completed signature, usb_host_os.c
+#define SETUP_TIMEOUT_MS 1000
+
+static const struct usb_setup_packet macos_13[] = {
+  SET_REPORT(FEATURE_REPORT, 9, 3),
+};
+
+static const struct usb_setup_packet macos_14_intel_cyber60_fake_apple[] = {
+  SET_REPORT(OUTPUT_REPORT, 1, 2), SET_REPORT(OUTPUT_REPORT, 1, 2),
+  SET_REPORT(OUTPUT_REPORT, 1, 2), SET_REPORT(OUTPUT_REPORT, 1, 2),
+  SET_REPORT(OUTPUT_REPORT, 1, 2), SET_REPORT(FEATURE_REPORT, 9, 3),
+};
+
+static const struct usb_setup_packet windows11_23H2_intel_cyber60[] = {
+  SET_REPORT(OUTPUT_REPORT, 1, 2),
+};
+
+ZMK_LISTENER_EXTERN(usb_host_os_usb_conn);
+ZMK_LISTENER_EXTERN(auto_switch_layer);
+
+static void connect(void) {
+  zmk_listener_usb_host_os_usb_conn.callback(
+    ZMK_EVENT(zmk_usb_conn_state_changed, .conn_state = ZMK_USB_CONN_HID));
+  zmk_usb_host_os_changed_raised = 0;
+}
+
+// feeds packets gap_ms apart
+static void replay(const struct usb_setup_packet *packets, size_t len, int gap_ms) {
+  for (int i = 0; i < len; i++) {
+    if (i > 0) {
+      k_msleep(gap_ms);
+    }
+    struct usb_setup_packet setup = packets[i];
+    zmk_usb_host_os_trace_hid_setup(&setup);
+  }
+}
+
+#define REPLAY(packets, gap_ms) replay(packets, ARRAY_SIZE(packets), gap_ms)
+
+// waits for the end of the detection, returns ms from now to the event
+static int64_t detection_latency(void) {
+  int64_t start = k_uptime_get();
+  while (!zmk_usb_host_os_changed_raised && k_uptime_get() - start < 2 * SETUP_TIMEOUT_MS) {
+    k_msleep(1);
+  }
+  zassert_equal(zmk_usb_host_os_changed_raised, 1, "os changed raised %d times",
+                zmk_usb_host_os_changed_raised);
+  return zmk_usb_host_os_changed_raised_at - start;
+}
+
+static void before(void *fixture) {
+  zmk_fakes_reset();
+  connect();
+}
+
+ZTEST(usb_host_os, test_macos_13_without_delay) {
+  REPLAY(macos_13, 0);
+  zassert_equal(detection_latency(), 0);
+  zassert_equal(zmk_usb_host_os_changed_last.data.os, USB_HOST_OS_DARWIN);
+  zassert_equal(zmk_usb_host_os_detected(), USB_HOST_OS_DARWIN);
+}
+
+ZTEST(usb_host_os, test_macos_14_late_feature_report) {
+  // feature report 9 comes well after the LED reports
+  REPLAY(macos_14_intel_cyber60_fake_apple, 300);
+  zassert_equal(detection_latency(), 0);
+  zassert_equal(zmk_usb_host_os_changed_last.data.os, USB_HOST_OS_DARWIN);
+}
+
+ZTEST(usb_host_os, test_led_report_only_waits_for_timeout) {
+  REPLAY(windows11_23H2_intel_cyber60, 0);
+  zassert_within(detection_latency(), SETUP_TIMEOUT_MS, 2);
+  zassert_equal(zmk_usb_host_os_changed_last.data.os, USB_HOST_OS_UNKNOWN);
+}
+
+ZTEST(usb_host_os, test_each_packet_restarts_timeout) {
+  REPLAY(macos_14_intel_cyber60_fake_apple, SETUP_TIMEOUT_MS / 2);
+  zassert_equal(detection_latency(), 0);
+  zassert_equal(zmk_usb_host_os_changed_last.data.os, USB_HOST_OS_DARWIN);
+}
+
+ZTEST(usb_host_os, test_no_request) {
+  zassert_within(detection_latency(), SETUP_TIMEOUT_MS, 2);
+  zassert_equal(zmk_usb_host_os_changed_last.data.os, USB_HOST_OS_UNKNOWN);
+}
+
+ZTEST(usb_host_os, test_reconnect_restarts_detection) {
+  REPLAY(macos_13, 0);
+  detection_latency();
+  connect();
+  zassert_equal(zmk_usb_host_os_detected(), USB_HOST_OS_UNDEFINED);
+  REPLAY(windows11_23H2_intel_cyber60, 0);
+  zassert_within(detection_latency(), SETUP_TIMEOUT_MS, 2);
+  zassert_equal(zmk_usb_host_os_detected(), USB_HOST_OS_UNKNOWN);
+}
+
+ZTEST_SUITE(usb_host_os, NULL, NULL, before, NULL, NULL);
+
+static void dispatch_os_changed(void) {
+  zmk_listener_auto_switch_layer.callback(&zmk_usb_host_os_changed_last.header);
+}
+
+ZTEST(usb_auto_switch_layer, test_darwin) {
+  REPLAY(macos_13, 0);
+  detection_latency();
+  dispatch_os_changed();
+  zassert_equal(zmk_keymap_layer_to_fake.call_count, 1);
+  zassert_equal(zmk_keymap_layer_to_fake.arg0_val, CONFIG_ZMK_USB_AUTO_SWITCH_LAYER_IF_DARWIN);
+}
+
+ZTEST(usb_auto_switch_layer, test_unless_darwin) {
+  REPLAY(windows11_23H2_intel_cyber60, 0);
+  detection_latency();
+  dispatch_os_changed();
+  zassert_equal(zmk_keymap_layer_to_fake.call_count, 1);
+  zassert_equal(zmk_keymap_layer_to_fake.arg0_val,
+                CONFIG_ZMK_USB_AUTO_SWITCH_LAYER_UNLESS_DARWIN);
+}
+
+ZTEST(usb_auto_switch_layer, test_ble_endpoint) {
+  REPLAY(macos_13, 0);
+  detection_latency();
+  zmk_endpoints_selected_fake.return_val =
+    (struct zmk_endpoint_instance){.transport = ZMK_TRANSPORT_BLE};
+  zmk_listener_auto_switch_layer.callback(ZMK_EVENT(
+    zmk_endpoint_changed, .endpoint = {.transport = ZMK_TRANSPORT_BLE}));
+  zassert_equal(zmk_keymap_layer_to_fake.call_count, 0);
+}
+
+ZTEST(usb_auto_switch_layer, test_detection_in_progress) {
+  // switched to USB before the host finished the setup
+  zmk_listener_auto_switch_layer.callback(ZMK_EVENT(
+    zmk_endpoint_changed, .endpoint = {.transport = ZMK_TRANSPORT_USB}));
+  zassert_equal(zmk_keymap_layer_to_fake.call_count, 0);
+}
+
+ZTEST_SUITE(usb_auto_switch_layer, NULL, NULL, before, NULL, NULL);
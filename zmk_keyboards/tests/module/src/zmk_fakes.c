@@ -0,0 +1,75 @@
+#include <zephyr/device.h>
+#include <zephyr/fff.h>
+#include <zephyr/logging/log.h>
+
+#include <zmk/endpoints.h>
+#include <zmk/events/endpoint_changed.h>
+#include <zmk/events/hid_indicators_changed.h>
+#include <zmk/events/keycode_state_changed.h>
+#include <zmk/events/layer_state_changed.h>
+#include <zmk/events/position_state_changed.h>
+#include <zmk/events/usb_conn_state_changed.h>
+#include <zmk/hid.h>
+#include <zmk/keymap.h>
+#include <zmk/keymap_hid.h>
+#include <zmk/report_interval.h>
+#include <zmk/usb.h>
+
+#include "zmk_fakes.h"
+
+LOG_MODULE_REGISTER(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+DEFINE_FFF_GLOBALS;
+
+ZMK_EVENT_IMPL(zmk_endpoint_changed);
+ZMK_EVENT_IMPL(zmk_hid_indicators_changed);
+ZMK_EVENT_IMPL(zmk_keycode_state_changed);
+ZMK_EVENT_IMPL(zmk_layer_state_changed);
+ZMK_EVENT_IMPL(zmk_position_state_changed);
+ZMK_EVENT_IMPL(zmk_usb_conn_state_changed);
+
+DEFINE_FAKE_VALUE_FUNC(int, zmk_keymap_layer_to, uint8_t);
+DEFINE_FAKE_VALUE_FUNC(struct zmk_endpoint_instance, zmk_endpoints_selected);
+DEFINE_FAKE_VALUE_FUNC(int, zmk_endpoints_send_radial_controller_report);
+DEFINE_FAKE_VOID_FUNC(zmk_hid_radial_controller_button_press);
+DEFINE_FAKE_VOID_FUNC(zmk_hid_radial_controller_button_release);
+DEFINE_FAKE_VOID_FUNC(zmk_hid_radial_controller_dial_rotate, int16_t);
+DEFINE_FAKE_VALUE_FUNC(int, zmk_report_interval_ms);
+DEFINE_FAKE_VALUE_FUNC(enum usb_dc_status_code, zmk_usb_get_status);
+DEFINE_FAKE_VALUE_FUNC(int, usb_wakeup_request);
+DEFINE_FAKE_VALUE_FUNC(int, hid_int_ep_write, const struct device *, const uint8_t *, uint32_t,
+                       uint32_t *);
+DEFINE_FAKE_VALUE_FUNC(int, usb_hid_init, const struct device *);
+DEFINE_FAKE_VALUE_FUNC(size_t, zmk_keymap_hid_handle_message, const uint8_t *, size_t, uint8_t *,
+                       size_t);
+
+// registered at boot, before any test resets the fakes
+const struct hid_ops *zmk_fakes_hid_ops;
+
+void usb_hid_register_device(const struct device *dev, const uint8_t *desc, size_t size,
+                             const struct hid_ops *ops) {
+  zmk_fakes_hid_ops = ops;
+}
+
+// the HID device keymap_usb_hid.c looks up by name
+DEVICE_DEFINE(hid_1, "HID_1", NULL, NULL, NULL, NULL, POST_KERNEL, 0, NULL);
+
+void zmk_fakes_reset(void) {
+  RESET_FAKE(zmk_keymap_layer_to);
+  RESET_FAKE(zmk_endpoints_selected);
+  RESET_FAKE(zmk_endpoints_send_radial_controller_report);
+  RESET_FAKE(zmk_hid_radial_controller_button_press);
+  RESET_FAKE(zmk_hid_radial_controller_button_release);
+  RESET_FAKE(zmk_hid_radial_controller_dial_rotate);
+  RESET_FAKE(zmk_report_interval_ms);
+  RESET_FAKE(zmk_usb_get_status);
+  RESET_FAKE(usb_wakeup_request);
+  RESET_FAKE(hid_int_ep_write);
+  RESET_FAKE(usb_hid_init);
+  RESET_FAKE(zmk_keymap_hid_handle_message);
+  FFF_RESET_HISTORY();
+  zmk_endpoints_selected_fake.return_val =
+    (struct zmk_endpoint_instance){.transport = ZMK_TRANSPORT_USB};
+  zmk_usb_get_status_fake.return_val = USB_DC_CONFIGURED;
+  zmk_report_interval_ms_fake.return_val = 10;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <zephyr/fff.h>
+#include <zephyr/usb/class/usb_hid.h>
+
+#include <zmk/endpoints_types.h>
+#include <zmk/usb.h>
+
+DECLARE_FAKE_VALUE_FUNC(int, zmk_keymap_layer_to, uint8_t);
+DECLARE_FAKE_VALUE_FUNC(struct zmk_endpoint_instance, zmk_endpoints_selected);
+DECLARE_FAKE_VALUE_FUNC(int, zmk_endpoints_send_radial_controller_report);
+DECLARE_FAKE_VOID_FUNC(zmk_hid_radial_controller_button_press);
+DECLARE_FAKE_VOID_FUNC(zmk_hid_radial_controller_button_release);
+DECLARE_FAKE_VOID_FUNC(zmk_hid_radial_controller_dial_rotate, int16_t);
+DECLARE_FAKE_VALUE_FUNC(int, zmk_report_interval_ms);
+DECLARE_FAKE_VALUE_FUNC(enum usb_dc_status_code, zmk_usb_get_status);
+DECLARE_FAKE_VALUE_FUNC(int, usb_wakeup_request);
+DECLARE_FAKE_VALUE_FUNC(int, hid_int_ep_write, const struct device *, const uint8_t *, uint32_t,
+                        uint32_t *);
+DECLARE_FAKE_VALUE_FUNC(int, usb_hid_init, const struct device *);
+DECLARE_FAKE_VALUE_FUNC(size_t, zmk_keymap_hid_handle_message, const uint8_t *, size_t, uint8_t *,
+                        size_t);
+
+extern const struct hid_ops *zmk_fakes_hid_ops;
+
+// resets every fake, then USB endpoint, configured bus and 10 ms report interval
+void zmk_fakes_reset(void);
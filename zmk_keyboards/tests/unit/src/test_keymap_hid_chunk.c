@@ -0,0 +1,128 @@
+#include <errno.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/ztest.h>
+
+#include <zmk/keymap_hid_chunk.h>
+
+LOG_MODULE_REGISTER(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+static struct zmk_keymap_hid_assembler assembler;
+static uint8_t message[CONFIG_ZMK_KEYMAP_HID_MAX_MESSAGE_BYTES + KEYMAP_HID_CHUNK_MAX_PAYLOAD];
+
+static void before(void *fixture) {
+  memset(&assembler, 0, sizeof(assembler));
+  for (int i = 0; i < sizeof(message); i++) {
+    message[i] = i * 7 + 1;
+  }
+}
+
+// splits the message into chunks and feeds them, returns the last result
+static int round_trip(uint8_t seq, size_t len, size_t max_payload) {
+  struct zmk_keymap_hid_report_body chunk;
+  size_t offset = 0;
+  int ret;
+  do {
+    offset += zmk_keymap_hid_fill_chunk(&chunk, seq, message, len, offset, max_payload);
+    ret = zmk_keymap_hid_assemble(&assembler, &chunk);
+  } while (ret == 0 && offset < len);
+  return ret;
+}
+
+ZTEST(keymap_hid_chunk, test_single_chunk) {
+  struct zmk_keymap_hid_report_body chunk;
+  zassert_equal(zmk_keymap_hid_fill_chunk(&chunk, 5, message, 10, 0, KEYMAP_HID_CHUNK_MAX_PAYLOAD),
+                10);
+  zassert_equal(chunk.seq, 5);
+  zassert_equal(chunk.ctrl, 0);
+  zassert_equal(chunk.len, 10);
+  // rest of the report is padded
+  for (int i = 10; i < KEYMAP_HID_CHUNK_MAX_PAYLOAD; i++) {
+    zassert_equal(chunk.payload[i], 0);
+  }
+  zassert_equal(zmk_keymap_hid_assemble(&assembler, &chunk), 1);
+  zassert_equal(assembler.len, 10);
+  zassert_mem_equal(assembler.buf, message, 10);
+}
+
+ZTEST(keymap_hid_chunk, test_empty_message) {
+  zassert_equal(round_trip(1, 0, KEYMAP_HID_CHUNK_MAX_PAYLOAD), 1);
+  zassert_equal(assembler.len, 0);
+}
+
+ZTEST(keymap_hid_chunk, test_multi_chunk_round_trip) {
+  const size_t payloads[] = {1, 20, KEYMAP_HID_CHUNK_MAX_PAYLOAD, 255};
+  for (int p = 0; p < ARRAY_SIZE(payloads); p++) {
+    size_t len = CONFIG_ZMK_KEYMAP_HID_MAX_MESSAGE_BYTES / 2 + 3;
+    if (payloads[p] == 1) {
+      // chunk index is 7 bits
+      len = KEYMAP_HID_CHUNK_INDEX_MASK + 1;
+    }
+    zassert_equal(round_trip(p, len, payloads[p]), 1, "max payload %d", payloads[p]);
+    zassert_equal(assembler.seq, p);
+    zassert_equal(assembler.len, len);
+    zassert_mem_equal(assembler.buf, message, len);
+  }
+}
+
+ZTEST(keymap_hid_chunk, test_chunk_header) {
+  struct zmk_keymap_hid_report_body chunk;
+  size_t max = KEYMAP_HID_CHUNK_MAX_PAYLOAD;
+  zmk_keymap_hid_fill_chunk(&chunk, 9, message, max * 2 + 1, max, max);
+  zassert_equal(chunk.ctrl, KEYMAP_HID_CHUNK_MORE | 1);
+  zmk_keymap_hid_fill_chunk(&chunk, 9, message, max * 2 + 1, max * 2, max);
+  zassert_equal(chunk.ctrl, 2);
+  zassert_equal(chunk.len, 1);
+  zassert_equal(chunk.payload[0], message[max * 2]);
+}
+
+ZTEST(keymap_hid_chunk, test_lost_chunk) {
+  struct zmk_keymap_hid_report_body chunk;
+  size_t len = KEYMAP_HID_CHUNK_MAX_PAYLOAD * 3;
+  zmk_keymap_hid_fill_chunk(&chunk, 1, message, len, 0, KEYMAP_HID_CHUNK_MAX_PAYLOAD);
+  zassert_equal(zmk_keymap_hid_assemble(&assembler, &chunk), 0);
+  // index 1 is lost
+  zmk_keymap_hid_fill_chunk(&chunk, 1, message, len, KEYMAP_HID_CHUNK_MAX_PAYLOAD * 2,
+                            KEYMAP_HID_CHUNK_MAX_PAYLOAD);
+  zassert_equal(zmk_keymap_hid_assemble(&assembler, &chunk), -EILSEQ);
+  // the rest of the message is dropped too
+  zassert_equal(zmk_keymap_hid_assemble(&assembler, &chunk), -EILSEQ);
+  // a new message is accepted
+  zassert_equal(round_trip(2, len, KEYMAP_HID_CHUNK_MAX_PAYLOAD), 1);
+  zassert_mem_equal(assembler.buf, message, len);
+}
+
+ZTEST(keymap_hid_chunk, test_seq_mismatch) {
+  struct zmk_keymap_hid_report_body chunk;
+  size_t len = KEYMAP_HID_CHUNK_MAX_PAYLOAD * 2;
+  zmk_keymap_hid_fill_chunk(&chunk, 1, message, len, 0, KEYMAP_HID_CHUNK_MAX_PAYLOAD);
+  zassert_equal(zmk_keymap_hid_assemble(&assembler, &chunk), 0);
+  zmk_keymap_hid_fill_chunk(&chunk, 2, message, len, KEYMAP_HID_CHUNK_MAX_PAYLOAD,
+                            KEYMAP_HID_CHUNK_MAX_PAYLOAD);
+  zassert_equal(zmk_keymap_hid_assemble(&assembler, &chunk), -EILSEQ);
+}
+
+ZTEST(keymap_hid_chunk, test_first_chunk_restarts) {
+  struct zmk_keymap_hid_report_body chunk;
+  zmk_keymap_hid_fill_chunk(&chunk, 1, message, KEYMAP_HID_CHUNK_MAX_PAYLOAD * 2, 0,
+                            KEYMAP_HID_CHUNK_MAX_PAYLOAD);
+  zassert_equal(zmk_keymap_hid_assemble(&assembler, &chunk), 0);
+  // the host gave up the previous message
+  zassert_equal(round_trip(2, 4, KEYMAP_HID_CHUNK_MAX_PAYLOAD), 1);
+  zassert_equal(assembler.len, 4);
+}
+
+ZTEST(keymap_hid_chunk, test_message_too_long) {
+  zassert_equal(round_trip(1, CONFIG_ZMK_KEYMAP_HID_MAX_MESSAGE_BYTES + 1,
+                           KEYMAP_HID_CHUNK_MAX_PAYLOAD),
+                -ENOMEM);
+  zassert_equal(round_trip(2, CONFIG_ZMK_KEYMAP_HID_MAX_MESSAGE_BYTES,
+                           KEYMAP_HID_CHUNK_MAX_PAYLOAD),
+                1);
+}
+
+ZTEST(keymap_hid_chunk, test_invalid_len) {
+  struct zmk_keymap_hid_report_body chunk = {.seq = 1, .len = KEYMAP_HID_CHUNK_MAX_PAYLOAD + 1};
+  zassert_equal(zmk_keymap_hid_assemble(&assembler, &chunk), -EINVAL);
+}
+
+ZTEST_SUITE(keymap_hid_chunk, NULL, NULL, before, NULL, NULL);
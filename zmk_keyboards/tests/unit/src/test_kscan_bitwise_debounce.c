@@ -0,0 +1,108 @@
+#include <zephyr/ztest.h>
+
+#include "kscan_bitwise_debounce.h"
+
+struct strobe {
+  uint32_t debounced;
+  uint32_t counter[KSCAN_BITWISE_COUNTER_BITS];
+};
+
+static struct strobe strobe;
+
+static uint32_t sample(uint32_t raw, uint8_t press_samples, uint8_t release_samples) {
+  return kscan_bitwise_debounce(&strobe.debounced, strobe.counter, raw, press_samples,
+                                release_samples);
+}
+
+// one key with the same semantics as ZMK's debounce.c
+struct reference_key {
+  bool pressed;
+  uint8_t counter;
+};
+
+static bool reference_sample(struct reference_key *key, bool raw, uint8_t press_samples,
+                             uint8_t release_samples) {
+  if (raw == key->pressed) {
+    key->counter = 0;
+    return false;
+  }
+  if (++key->counter < (raw ? press_samples : release_samples)) {
+    return false;
+  }
+  key->pressed = raw;
+  key->counter = 0;
+  return true;
+}
+
+static uint32_t lcg(uint32_t *seed) {
+  *seed = *seed * 1664525 + 1013904223;
+  return *seed;
+}
+
+static void before(void *fixture) { memset(&strobe, 0, sizeof(strobe)); }
+
+ZTEST(kscan_bitwise_debounce, test_eager_press) {
+  zassert_equal(sample(BIT(3), 1, 5), BIT(3));
+  zassert_equal(strobe.debounced, BIT(3));
+}
+
+ZTEST(kscan_bitwise_debounce, test_release_after_samples) {
+  sample(BIT(0), 1, 5);
+  for (int i = 0; i < 4; i++) {
+    zassert_equal(sample(0, 1, 5), 0, "released at sample %d", i);
+  }
+  zassert_equal(sample(0, 1, 5), BIT(0));
+  zassert_equal(strobe.debounced, 0);
+}
+
+ZTEST(kscan_bitwise_debounce, test_bounce_restarts_count) {
+  sample(0x1, 3, 3);
+  sample(0x1, 3, 3);
+  // bounce
+  sample(0x0, 3, 3);
+  zassert_equal(sample(0x1, 3, 3), 0);
+  zassert_equal(sample(0x1, 3, 3), 0);
+  zassert_equal(sample(0x1, 3, 3), 0x1);
+}
+
+ZTEST(kscan_bitwise_debounce, test_counter_cleared_on_change) {
+  for (int i = 0; i < 3; i++) {
+    sample(UINT32_MAX, 3, 3);
+  }
+  zassert_equal(strobe.debounced, UINT32_MAX);
+  for (int b = 0; b < KSCAN_BITWISE_COUNTER_BITS; b++) {
+    zassert_equal(strobe.counter[b], 0);
+  }
+}
+
+ZTEST(kscan_bitwise_debounce, test_max_samples) {
+  for (int i = 0; i < KSCAN_BITWISE_COUNTER_MAX - 1; i++) {
+    zassert_equal(sample(BIT(31), KSCAN_BITWISE_COUNTER_MAX, 1), 0);
+  }
+  zassert_equal(sample(BIT(31), KSCAN_BITWISE_COUNTER_MAX, 1), BIT(31));
+}
+
+// 32 keys with bouncy random inputs, each bit follows the per key reference
+ZTEST(kscan_bitwise_debounce, test_matches_reference) {
+  const uint8_t samples[][2] = {{1, 1}, {1, 5}, {2, 3}, {5, 5}, {6, 11}};
+  for (int s = 0; s < ARRAY_SIZE(samples); s++) {
+    struct reference_key keys[32] = {0};
+    uint32_t raw = 0;
+    uint32_t seed = 0x12345678;
+    memset(&strobe, 0, sizeof(strobe));
+    for (int i = 0; i < 2000; i++) {
+      // each input flips with 1/4 chance per sample
+      raw ^= lcg(&seed) & lcg(&seed);
+      uint32_t expected = 0;
+      for (int k = 0; k < 32; k++) {
+        if (reference_sample(&keys[k], raw & BIT(k), samples[s][0], samples[s][1])) {
+          expected |= BIT(k);
+        }
+      }
+      zassert_equal(sample(raw, samples[s][0], samples[s][1]), expected,
+                    "samples %d/%d, at %d", samples[s][0], samples[s][1], i);
+    }
+  }
+}
+
+ZTEST_SUITE(kscan_bitwise_debounce, NULL, NULL, before, NULL, NULL);
@@ -0,0 +1,98 @@
+#include <zephyr/usb/class/hid.h>
+#include <zephyr/ztest.h>
+
+#include <zmk/usb_host_os.h>
+
+// HID class requests from resources/usb_hid_class_setup_log.js and
+// resources/zmk_usb_setup_log.js (CDC ACM requests removed).
+#define SET_REPORT(type, id, len)                                                                  \
+  {.bmRequestType = 0x21, .bRequest = USB_HID_SET_REPORT, .wValue = (type) << 8 | (id),           \
+   .wIndex = 2, .wLength = (len)}
+#define OUTPUT_REPORT 2
+#define FEATURE_REPORT 3
+
+static const struct usb_setup_packet macos_13[] = {
+  SET_REPORT(FEATURE_REPORT, 9, 3),
+};
+
+static const struct usb_setup_packet macos_14_intel_cyber60_fake_apple[] = {
+  SET_REPORT(OUTPUT_REPORT, 1, 2), SET_REPORT(OUTPUT_REPORT, 1, 2),
+  SET_REPORT(OUTPUT_REPORT, 1, 2), SET_REPORT(OUTPUT_REPORT, 1, 2),
+  SET_REPORT(OUTPUT_REPORT, 1, 2), SET_REPORT(FEATURE_REPORT, 9, 3),
+};
+
+static const struct usb_setup_packet windows11_23H2_intel_cyber60[] = {
+  SET_REPORT(OUTPUT_REPORT, 1, 2),
+};
+
+static struct zmk_usb_host_os_matcher matcher;
+
+// feeds packets, returns the first certain os, USB_HOST_OS_UNDEFINED if none
+static enum usb_host_os replay(const struct usb_setup_packet *packets, size_t len) {
+  for (int i = 0; i < len; i++) {
+    enum usb_host_os os = zmk_usb_host_os_match(&matcher, &packets[i]);
+    if (os != USB_HOST_OS_UNDEFINED) {
+      zassert_equal(i, len - 1, "decided before the last packet");
+      return os;
+    }
+  }
+  return USB_HOST_OS_UNDEFINED;
+}
+
+#define REPLAY(packets) replay(packets, ARRAY_SIZE(packets))
+
+static void before(void *fixture) { zmk_usb_host_os_match_reset(&matcher); }
+
+ZTEST(usb_host_os_signature, test_macos_13) {
+  zassert_equal(REPLAY(macos_13), USB_HOST_OS_DARWIN);
+}
+
+ZTEST(usb_host_os_signature, test_macos_14) {
+  zassert_equal(REPLAY(macos_14_intel_cyber60_fake_apple), USB_HOST_OS_DARWIN);
+}
+
+ZTEST(usb_host_os_signature, test_windows_11) {
+  // LED report only, also sent by linux and the start of macOS 14
+  zassert_equal(REPLAY(windows11_23H2_intel_cyber60), USB_HOST_OS_UNDEFINED);
+  zassert_equal(zmk_usb_host_os_match_completed(&matcher), USB_HOST_OS_UNKNOWN);
+}
+
+ZTEST(usb_host_os_signature, test_repeated_packets_are_folded) {
+  const struct usb_setup_packet led = SET_REPORT(OUTPUT_REPORT, 1, 2);
+  for (int i = 0; i < 20; i++) {
+    zassert_equal(zmk_usb_host_os_match(&matcher, &led), USB_HOST_OS_UNDEFINED);
+  }
+  zassert_equal(matcher.step, 1);
+}
+
+ZTEST(usb_host_os_signature, test_unknown_request) {
+  const struct usb_setup_packet get_report = {
+    .bmRequestType = 0xa1, .bRequest = USB_HID_GET_REPORT, .wValue = 0x0101, .wLength = 8};
+  // no signature left, certain without waiting
+  zassert_equal(zmk_usb_host_os_match(&matcher, &get_report), USB_HOST_OS_UNKNOWN);
+}
+
+ZTEST(usb_host_os_signature, test_no_request) {
+  zassert_equal(zmk_usb_host_os_match_completed(&matcher), USB_HOST_OS_UNKNOWN);
+}
+
+ZTEST(usb_host_os_signature, test_wrong_length) {
+  const struct usb_setup_packet feature = SET_REPORT(FEATURE_REPORT, 9, 4);
+  zassert_equal(zmk_usb_host_os_match(&matcher, &feature), USB_HOST_OS_UNKNOWN);
+}
+
+ZTEST(usb_host_os_signature, test_led_then_unknown) {
+  const struct usb_setup_packet led = SET_REPORT(OUTPUT_REPORT, 1, 2);
+  const struct usb_setup_packet feature = SET_REPORT(FEATURE_REPORT, 9, 4);
+  zassert_equal(zmk_usb_host_os_match(&matcher, &led), USB_HOST_OS_UNDEFINED);
+  // macOS 14 prefix broken, nothing completed
+  zassert_equal(zmk_usb_host_os_match(&matcher, &feature), USB_HOST_OS_UNKNOWN);
+}
+
+ZTEST(usb_host_os_signature, test_reset) {
+  REPLAY(windows11_23H2_intel_cyber60);
+  zmk_usb_host_os_match_reset(&matcher);
+  zassert_equal(REPLAY(macos_13), USB_HOST_OS_DARWIN);
+}
+
+ZTEST_SUITE(usb_host_os_signature, NULL, NULL, before, NULL, NULL);